@@ -0,0 +1,23 @@
+// and_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+
+#include "handler.h"
+
+bool and_handler(Parser state, Instruction instruction)
+{
+    if (!parser_execute(state, instruction->left))
+    {
+        return false;
+    }
+
+    if (state->status)
+    {
+        return true;
+    }
+
+    return parser_execute(state, instruction->right);
+}
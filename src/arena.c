@@ -0,0 +1,179 @@
+// arena.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://en.wikipedia.org/wiki/Region-based_memory_management
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#define ARENA_ALIGNMENT 16
+
+void arena(Arena instance, size_t capacity)
+{
+    if (capacity < 256)
+    {
+        capacity = 256;
+    }
+
+    instance->capacity = capacity;
+    instance->first = NULL;
+}
+
+static size_t arena_padding(ArenaBlock block)
+{
+    uintptr_t address = (uintptr_t)(block->items + block->size);
+
+    return (ARENA_ALIGNMENT - address % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+}
+
+void* arena_allocate(Arena instance, size_t size)
+{
+    ArenaBlock block = instance->first;
+
+    if (block)
+    {
+        size_t padding = arena_padding(block);
+
+        if (block->capacity - block->size >= padding + size)
+        {
+            void* result = block->items + block->size + padding;
+
+            block->size += padding + size;
+
+            return result;
+        }
+    }
+
+    size_t capacity = instance->capacity;
+
+    if (block)
+    {
+        capacity = block->capacity * 2;
+    }
+
+    if (capacity < size + ARENA_ALIGNMENT)
+    {
+        capacity = size + ARENA_ALIGNMENT;
+    }
+
+    ArenaBlock newBlock = malloc(sizeof * newBlock + capacity);
+
+    if (!newBlock)
+    {
+        return NULL;
+    }
+
+    newBlock->next = block;
+    newBlock->size = 0;
+    newBlock->capacity = capacity;
+    instance->first = newBlock;
+
+    size_t padding = arena_padding(newBlock);
+
+    newBlock->size = padding + size;
+
+    return newBlock->items + padding;
+}
+
+void* arena_allocate_zero(Arena instance, size_t size)
+{
+    void* result = arena_allocate(instance, size);
+
+    if (result)
+    {
+        memset(result, 0, size);
+    }
+
+    return result;
+}
+
+String arena_copy(Arena instance, String value, size_t length)
+{
+    String result = arena_allocate(instance, length + 1);
+
+    if (!result)
+    {
+        return NULL;
+    }
+
+    if (length)
+    {
+        memcpy(result, value, length);
+    }
+
+    result[length] = '\0';
+
+    return result;
+}
+
+void arena_move(Arena instance, Arena source)
+{
+    instance->capacity = source->capacity;
+    instance->first = source->first;
+    source->first = NULL;
+}
+
+struct ArenaMark arena_mark(Arena instance)
+{
+    struct ArenaMark result =
+    {
+        .block = instance->first
+    };
+
+    if (result.block)
+    {
+        result.size = result.block->size;
+    }
+
+    return result;
+}
+
+void arena_rewind(Arena instance, struct ArenaMark mark)
+{
+    while (instance->first != mark.block)
+    {
+        ArenaBlock next = instance->first->next;
+
+        free(instance->first);
+
+        instance->first = next;
+    }
+
+    if (mark.block)
+    {
+        mark.block->size = mark.size;
+    }
+}
+
+void arena_reset(Arena instance)
+{
+    if (!instance->first)
+    {
+        return;
+    }
+
+    ArenaBlock block = instance->first->next;
+
+    while (block)
+    {
+        ArenaBlock next = block->next;
+
+        free(block);
+
+        block = next;
+    }
+
+    instance->first->next = NULL;
+    instance->first->size = 0;
+}
+
+void finalize_arena(Arena instance)
+{
+    arena_reset(instance);
+    free(instance->first);
+
+    instance->first = NULL;
+}
@@ -0,0 +1,46 @@
+// arena.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://en.wikipedia.org/wiki/Region-based_memory_management
+
+#ifndef ARENA_97c9805350434ae9830f1b7d705a7817
+#define ARENA_97c9805350434ae9830f1b7d705a7817
+#include <stddef.h>
+#include "euler.h"
+
+struct ArenaBlock
+{
+    struct ArenaBlock* next;
+    size_t size;
+    size_t capacity;
+    char items[];
+};
+
+struct Arena
+{
+    size_t capacity;
+    struct ArenaBlock* first;
+};
+
+struct ArenaMark
+{
+    struct ArenaBlock* block;
+    size_t size;
+};
+
+typedef struct ArenaBlock* ArenaBlock;
+typedef struct Arena* Arena;
+
+void arena(Arena instance, size_t capacity);
+void* arena_allocate(Arena instance, size_t size);
+void* arena_allocate_zero(Arena instance, size_t size);
+String arena_copy(Arena instance, String value, size_t length);
+void arena_move(Arena instance, Arena source);
+struct ArenaMark arena_mark(Arena instance);
+void arena_rewind(Arena instance, struct ArenaMark mark);
+void arena_reset(Arena instance);
+void finalize_arena(Arena instance);
+
+#endif
@@ -2,12 +2,7 @@
 // Copyright (c) 2024 Ishan Pranav
 // Licensed under the MIT license.
 
-// References:
-//  - https://www.man7.org/linux/man-pages/man3/strdup.3.html
-
-#include <string.h>
 #include "argument_vector.h"
-#define ARGUMENT_VECTOR_DELIMITERS " \r\n"
 
 Exception argument_vector(ArgumentVector instance, size_t capacity)
 {
@@ -62,52 +57,17 @@ Exception argument_vector_ensure_capacity(
     return 0;
 }
 
-Exception argument_vector_tokenize(ArgumentVector instance, String value)
-{
-    size_t count = instance->count;
-
-    for (String token = strtok(value, ARGUMENT_VECTOR_DELIMITERS);
-        token;
-        token = strtok(NULL, ARGUMENT_VECTOR_DELIMITERS))
-    {
-        Exception ex = argument_vector_ensure_capacity(instance, count + 1);
-
-        if (ex)
-        {
-            return ex;
-        }
-
-        String clone = strdup(token);
-
-        if (!clone)
-        {
-            return EXCEPTION_OUT_OF_MEMORY;
-        }
-
-        instance->buffer[count] = clone;
-        count++;
-    }
-
-    instance->buffer[count] = NULL;
-    instance->count = count;
-    
-    return 0;
-}
-
 void argument_vector_clear(ArgumentVector instance)
 {
-    while (instance->count)
-    {
-        instance->count--;
-
-        free(instance->buffer[instance->count]);
-    }
-
+    instance->count = 0;
     instance->buffer[0] = NULL;
 }
 
 void finalize_argument_vector(ArgumentVector instance)
 {
-    argument_vector_clear(instance);
+    instance->count = 0;
+
     free(instance->buffer);
+
+    instance->buffer = NULL;
 }
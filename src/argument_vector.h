@@ -22,7 +22,6 @@ Exception argument_vector_ensure_capacity(
     ArgumentVector instance,
     size_t capacity);
 
-Exception argument_vector_tokenize(ArgumentVector instance, String value);
 void argument_vector_clear(ArgumentVector instance);
 void finalize_argument_vector(ArgumentVector instance);
 
@@ -0,0 +1,34 @@
+// assignment_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+
+#include <string.h>
+#include "handler.h"
+
+bool assignment_handler(Parser state, Instruction instruction)
+{
+    for (size_t i = 0; i < instruction->assignmentCount; i++)
+    {
+        String variable = instruction->variables[i];
+        String separator = strchr(variable, '=');
+
+        euler_ok(variable_table_set(
+            &state->variables,
+            variable,
+            separator - variable,
+            separator + 1));
+    }
+
+    // Without a command substitution the status is zero; otherwise it is the
+    // status of the last substitution, which expansion has already recorded.
+
+    if (!state->substituted)
+    {
+        state->status = 0;
+    }
+
+    return true;
+}
@@ -0,0 +1,57 @@
+// background_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man3/killpg.3.html
+//  - https://www.gnu.org/software/libc/manual/html_node/Continuing-Stopped-Jobs.html
+
+#include <signal.h>
+#include "handler.h"
+
+bool background_handler(Parser state, Instruction instruction)
+{
+    JobCollection jobs = &state->jobs;
+    size_t id = job_collection_find(jobs, instruction->arguments[1]);
+    Job item = job_collection_get(jobs, id);
+
+    if (!item)
+    {
+        fprintf(stderr, "Error: invalid job\n");
+
+        state->status = 1;
+
+        return true;
+    }
+
+    // The shell itself drives a parallel pool, so it can only resume one in
+    // the foreground.
+
+    if (parallel_handler_owns(state, id))
+    {
+        fprintf(stderr, "Error: job must run in foreground\n");
+
+        state->status = 1;
+
+        return true;
+    }
+
+    if (item->state != JOB_STATE_STOPPED)
+    {
+        fprintf(stderr, "Error: job already in background\n");
+
+        state->status = 1;
+
+        return true;
+    }
+
+    killpg(item->group, SIGCONT);
+
+    item->state = JOB_STATE_RUNNING;
+
+    printf("[%zu] %s &\n", id, item->text);
+
+    state->status = 0;
+
+    return true;
+}
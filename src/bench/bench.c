@@ -0,0 +1,278 @@
+// bench.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man3/clock_gettime.3.html
+//  - https://jsonlines.org/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "euler.h"
+#include "job_collection.h"
+#include "lexer.h"
+#include "parser.h"
+#define BENCH_SHORT "ls -l /tmp > out.txt 2>&1"
+#define BENCH_WORDS 1000
+#define BENCH_STAGES 100
+#define BENCH_JOBS 10000
+
+struct Bench
+{
+    size_t scale;
+    size_t shortLength;
+    char* shortLine;
+    size_t longLength;
+    char* longLine;
+    size_t pipelineLength;
+    char* pipelineLine;
+};
+
+typedef struct Bench* Bench;
+
+static uint64_t bench_now(void)
+{
+    struct timespec now;
+
+    euler_assert(clock_gettime(CLOCK_MONOTONIC, &now) != -1);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static void bench_report(String name, size_t iterations, uint64_t start)
+{
+    uint64_t elapsed = bench_now() - start;
+
+    printf(
+        "{\"benchmark\":\"%s\",\"iterations\":%zu,\"total_ns\":%llu,"
+        "\"ns_per_op\":%.1f}\n",
+        name,
+        iterations,
+        (unsigned long long)elapsed,
+        (double)elapsed / iterations);
+}
+
+static char* bench_repeat(
+    String value,
+    size_t count,
+    String last,
+    size_t* length)
+{
+    size_t valueLength = strlen(value);
+    size_t lastLength = strlen(last);
+    char* result = malloc(valueLength * count + lastLength + 1);
+
+    euler_assert(result);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        memcpy(result + i * valueLength, value, valueLength);
+    }
+
+    memcpy(result + valueLength * count, last, lastLength + 1);
+
+    *length = valueLength * count + lastLength;
+
+    return result;
+}
+
+static void bench_lexer(Bench instance)
+{
+    struct Lexer tokens;
+    size_t iterations = 100000 * instance->scale;
+
+    euler_ok(lexer(&tokens, 0));
+
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        lexer_clear(&tokens);
+        euler_ok(lexer_tokenize(
+            &tokens,
+            instance->shortLine,
+            instance->shortLength));
+    }
+
+    bench_report("lexer_tokenize/short", iterations, start);
+
+    iterations = 1000 * instance->scale;
+    start = bench_now();
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        lexer_clear(&tokens);
+        euler_ok(lexer_tokenize(
+            &tokens,
+            instance->longLine,
+            instance->longLength));
+    }
+
+    bench_report("lexer_tokenize/long", iterations, start);
+    finalize_lexer(&tokens);
+}
+
+static void bench_parser_line(
+    Parser state,
+    String name,
+    String line,
+    size_t length,
+    size_t iterations)
+{
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        euler_ok(parser_parse(state, line, length));
+        euler_assert(!state->faulted);
+    }
+
+    bench_report(name, iterations, start);
+}
+
+static void bench_parser(Bench instance)
+{
+    struct Parser state;
+
+    euler_ok(parser(&state));
+
+    // Each case parses one line over and over, so the parse cache would turn
+    // every call after the second into a lookup.
+
+    finalize_parse_cache(&state.cache);
+    euler_ok(parse_cache(&state.cache, 0));
+    bench_parser_line(
+        &state,
+        "parser_parse/short",
+        instance->shortLine,
+        instance->shortLength,
+        100000 * instance->scale);
+    bench_parser_line(
+        &state,
+        "parser_parse/long",
+        instance->longLine,
+        instance->longLength,
+        1000 * instance->scale);
+    bench_parser_line(
+        &state,
+        "parser_parse/pipeline",
+        instance->pipelineLine,
+        instance->pipelineLength,
+        1000 * instance->scale);
+    finalize_parser(&state);
+}
+
+static void bench_parse_cache(Bench instance)
+{
+    struct Parser state;
+
+    euler_ok(parser(&state));
+    euler_ok(parser_parse(&state, instance->shortLine, instance->shortLength));
+    euler_ok(parser_parse(&state, instance->shortLine, instance->shortLength));
+    bench_parser_line(
+        &state,
+        "parse_cache/hit",
+        instance->shortLine,
+        instance->shortLength,
+        100000 * instance->scale);
+    euler_assert(state.cache.hits >= 100000 * instance->scale);
+    finalize_parser(&state);
+}
+
+static void bench_job_collection(Bench instance)
+{
+    struct JobCollection jobs;
+    size_t count = BENCH_JOBS * instance->scale;
+    pid_t pids[3];
+    int statuses[3];
+    struct rusage usages[3];
+
+    euler_ok(job_collection(&jobs, 0));
+
+    uint64_t start = bench_now();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        struct Job item;
+        size_t id;
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            pids[j] = (pid_t)(1000000 + i * 3 + j);
+        }
+
+        job(&item, "sleep 1 | cat | cat", pids, statuses, usages, 3);
+        euler_ok(job_collection_add(&jobs, &item, &id));
+    }
+
+    bench_report("job_collection_add", count, start);
+
+    start = bench_now();
+
+    for (size_t i = 0; i < count * 3; i++)
+    {
+        pid_t pid = (pid_t)(1000000 + (i * 7919) % (count * 3));
+
+        euler_assert(job_collection_find_process(&jobs, pid));
+    }
+
+    bench_report("job_collection_find_process", count * 3, start);
+
+    start = bench_now();
+
+    for (size_t i = 1; i <= count; i += 2)
+    {
+        euler_ok(job_collection_remove(&jobs, i));
+    }
+
+    for (size_t i = 2; i <= count; i += 2)
+    {
+        euler_ok(job_collection_remove(&jobs, i));
+    }
+
+    bench_report("job_collection_remove", count, start);
+    finalize_job_collection(&jobs);
+}
+
+int main(int count, String arguments[])
+{
+    struct Bench instance;
+
+    instance.scale = 1;
+
+    if (count > 1)
+    {
+        instance.scale = strtoull(arguments[1], NULL, 10);
+
+        if (!instance.scale)
+        {
+            fprintf(stderr, "Error: invalid number\n");
+
+            return 1;
+        }
+    }
+
+    instance.shortLength = strlen(BENCH_SHORT);
+    instance.shortLine = BENCH_SHORT;
+    instance.longLine = bench_repeat(
+        "word ",
+        BENCH_WORDS,
+        "end",
+        &instance.longLength);
+    instance.pipelineLine = bench_repeat(
+        "cat | ",
+        BENCH_STAGES,
+        "cat",
+        &instance.pipelineLength);
+
+    bench_lexer(&instance);
+    bench_parser(&instance);
+    bench_parse_cache(&instance);
+    bench_job_collection(&instance);
+    free(instance.longLine);
+    free(instance.pipelineLine);
+
+    return 0;
+}
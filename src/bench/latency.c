@@ -0,0 +1,310 @@
+// latency.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man3/posix_openpt.3.html
+//  - https://www.man7.org/linux/man-pages/man2/setsid.2.html
+//  - https://www.man7.org/linux/man-pages/man2/poll.2.html
+//  - https://jsonlines.org/
+
+#define _GNU_SOURCE
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "euler.h"
+#define LATENCY_PROMPT "]$ "
+#define LATENCY_TIMEOUT 5000
+#define LATENCY_BUFFER 65536
+
+struct Latency
+{
+    int descriptor;
+    pid_t pid;
+    size_t length;
+    char buffer[LATENCY_BUFFER];
+};
+
+typedef struct Latency* Latency;
+
+static uint64_t latency_now(void)
+{
+    struct timespec now;
+
+    euler_assert(clock_gettime(CLOCK_MONOTONIC, &now) != -1);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static bool latency_start(Latency instance, String path, String home)
+{
+    instance->pid = -1;
+    instance->descriptor = posix_openpt(O_NOCTTY | O_RDWR);
+
+    if (instance->descriptor == -1 ||
+        grantpt(instance->descriptor) == -1 ||
+        unlockpt(instance->descriptor) == -1)
+    {
+        return false;
+    }
+
+    String terminal = ptsname(instance->descriptor);
+
+    if (!terminal)
+    {
+        return false;
+    }
+
+    instance->pid = fork();
+
+    if (instance->pid == -1)
+    {
+        return false;
+    }
+
+    if (!instance->pid)
+    {
+        setsid();
+
+        int descriptor = open(terminal, O_RDWR);
+
+        if (descriptor == -1)
+        {
+            _exit(EXIT_FAILURE);
+        }
+
+        dup2(descriptor, STDIN_FILENO);
+        dup2(descriptor, STDOUT_FILENO);
+        dup2(descriptor, STDERR_FILENO);
+        close(descriptor);
+        close(instance->descriptor);
+        setenv("HOME", home, 1);
+        execl(path, path, (char*)NULL);
+        _exit(127);
+    }
+
+    instance->length = 0;
+
+    return true;
+}
+
+static bool latency_wait(Latency instance, bool command)
+{
+    size_t length = 0;
+    size_t newline = command ? 0 : 1;
+
+    for (;;)
+    {
+        if (newline)
+        {
+            instance->buffer[length] = '\0';
+
+            String start = instance->buffer + newline - 1;
+
+            if (strstr(start, LATENCY_PROMPT))
+            {
+                return true;
+            }
+        }
+
+        struct pollfd request = { instance->descriptor, POLLIN, 0 };
+
+        if (poll(&request, 1, LATENCY_TIMEOUT) != 1)
+        {
+            return false;
+        }
+
+        if (length + 1 >= sizeof instance->buffer)
+        {
+            length = 0;
+            newline = newline ? 1 : 0;
+        }
+
+        ssize_t count = read(
+            instance->descriptor,
+            instance->buffer + length,
+            sizeof instance->buffer - length - 1);
+
+        if (count <= 0)
+        {
+            return false;
+        }
+
+        if (!newline)
+        {
+            String found = memchr(instance->buffer + length, '\n', count);
+
+            if (found)
+            {
+                newline = found - instance->buffer + 1;
+            }
+        }
+
+        length += count;
+    }
+}
+
+static int latency_compare(const void* left, const void* right)
+{
+    uint64_t a = *(const uint64_t*)left;
+    uint64_t b = *(const uint64_t*)right;
+
+    return (a > b) - (a < b);
+}
+
+static uint64_t latency_percentile(
+    uint64_t samples[],
+    size_t count,
+    size_t percent)
+{
+    size_t index = (count * percent + 99) / 100;
+
+    if (index)
+    {
+        index--;
+    }
+
+    return samples[index];
+}
+
+static bool latency_measure(
+    Latency instance,
+    String name,
+    String command,
+    size_t count)
+{
+    uint64_t* samples = malloc(count * sizeof * samples);
+    size_t length = strlen(command);
+    uint64_t total = 0;
+
+    euler_assert(samples);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t start = latency_now();
+
+        if (write(instance->descriptor, command, length) != (ssize_t)length ||
+            !latency_wait(instance, true))
+        {
+            free(samples);
+
+            return false;
+        }
+
+        samples[i] = latency_now() - start;
+        total += samples[i];
+    }
+
+    qsort(samples, count, sizeof * samples, latency_compare);
+    printf(
+        "{\"benchmark\":\"latency/%s\",\"iterations\":%zu,"
+        "\"mean_ns\":%llu,\"p50_ns\":%llu,\"p90_ns\":%llu,"
+        "\"p99_ns\":%llu,\"max_ns\":%llu}\n",
+        name,
+        count,
+        (unsigned long long)(total / count),
+        (unsigned long long)latency_percentile(samples, count, 50),
+        (unsigned long long)latency_percentile(samples, count, 90),
+        (unsigned long long)latency_percentile(samples, count, 99),
+        (unsigned long long)samples[count - 1]);
+    fflush(stdout);
+    free(samples);
+
+    return true;
+}
+
+static String latency_pipeline(size_t stages)
+{
+    size_t length = sizeof "echo x" + stages * sizeof " | cat" + 1;
+    String result = malloc(length);
+
+    euler_assert(result);
+    strcpy(result, "echo x");
+
+    for (size_t i = 0; i < stages; i++)
+    {
+        strcat(result, " | cat");
+    }
+
+    strcat(result, "\n");
+
+    return result;
+}
+
+int main(int count, String arguments[])
+{
+    if (count < 2)
+    {
+        fprintf(stderr, "Usage: latency NYUSH [ITERATIONS]\n");
+
+        return 1;
+    }
+
+    size_t iterations = 200;
+
+    if (count > 2)
+    {
+        iterations = strtoull(arguments[2], NULL, 10);
+
+        if (!iterations)
+        {
+            fprintf(stderr, "Error: invalid number\n");
+
+            return 1;
+        }
+    }
+
+    char home[] = "/tmp/nyush-latency-XXXXXX";
+
+    if (!mkdtemp(home))
+    {
+        fprintf(stderr, "Error: invalid directory\n");
+
+        return 1;
+    }
+
+    struct Latency instance;
+    bool result = latency_start(&instance, arguments[1], home) &&
+        latency_wait(&instance, false);
+    String pipeline2 = latency_pipeline(2);
+    String pipeline8 = latency_pipeline(8);
+
+    result = result &&
+        latency_measure(&instance, "true", "true\n", iterations) &&
+        latency_measure(&instance, "echo", "echo x\n", iterations) &&
+        latency_measure(&instance, "program", "sleep 0\n", iterations) &&
+        latency_measure(&instance, "cat_2", pipeline2, iterations) &&
+        latency_measure(&instance, "cat_8", pipeline8, iterations);
+
+    free(pipeline2);
+    free(pipeline8);
+
+    if (instance.pid > 0)
+    {
+        kill(instance.pid, SIGKILL);
+        waitpid(instance.pid, NULL, 0);
+    }
+
+    char history[sizeof home + sizeof "/.nyush_history"];
+
+    snprintf(history, sizeof history, "%s/.nyush_history", home);
+    unlink(history);
+    rmdir(home);
+
+    if (!result)
+    {
+        fprintf(stderr, "Error: invalid program\n");
+
+        return 1;
+    }
+
+    return 0;
+}
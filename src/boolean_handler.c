@@ -0,0 +1,27 @@
+// boolean_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/true.html
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/false.html
+
+#include "handler.h"
+
+int true_handler(
+    EULER_UNUSED Parser state,
+    EULER_UNUSED Instruction instruction,
+    EULER_UNUSED int input,
+    EULER_UNUSED int output)
+{
+    return 0;
+}
+
+int false_handler(
+    EULER_UNUSED Parser state,
+    EULER_UNUSED Instruction instruction,
+    EULER_UNUSED int input,
+    EULER_UNUSED int output)
+{
+    return 1;
+}
@@ -0,0 +1,54 @@
+// builtin_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.gnu.org/software/bash/manual/html_node/Bourne-Shell-Builtins.html
+//  - https://www.man7.org/linux/man-pages/man3/bsearch.3.html
+
+#include <stdlib.h>
+#include <string.h>
+#include "handler.h"
+
+static const struct Builtin BUILTIN_HANDLERS[] =
+{
+    { "[", test_handler, NULL, false },
+    { "cat", concatenate_handler, concatenate_handler_accepts, true },
+    { "echo", echo_handler, NULL, false },
+    { "export", export_handler, NULL, false },
+    { "false", false_handler, NULL, false },
+    { "history", history_handler, NULL, false },
+    { "parallel", parallel_handler, NULL, false },
+    { "printf", printf_handler, printf_handler_accepts, false },
+    {
+        "pwd",
+        print_working_directory_handler,
+        print_working_directory_handler_accepts,
+        false
+    },
+    { "test", test_handler, NULL, false },
+    { "true", true_handler, NULL, false },
+    { "unset", unset_handler, NULL, false }
+};
+
+static int builtin_handler_compare(const void* left, const void* right)
+{
+    return strcmp(left, ((Builtin)right)->name);
+}
+
+Builtin builtin_handler_find(Instruction instruction)
+{
+    Builtin result = bsearch(
+        instruction->arguments[0],
+        BUILTIN_HANDLERS,
+        sizeof BUILTIN_HANDLERS / sizeof * BUILTIN_HANDLERS,
+        sizeof * BUILTIN_HANDLERS,
+        builtin_handler_compare);
+
+    if (result && result->accepts && !result->accepts(instruction))
+    {
+        return NULL;
+    }
+
+    return result;
+}
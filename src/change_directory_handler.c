@@ -4,19 +4,46 @@
 
 // References:
 //  - https://www.man7.org/linux/man-pages/man2/chdir.2.html
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/cd.html
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include "handler.h"
 
-bool change_directory_handler(
-    EULER_UNUSED JobCollection jobs, 
-    Instruction instruction)
+bool change_directory_handler(Parser state, Instruction instruction)
 {
-    if (chdir(instruction->payload.argument) == -1)
+    String path = instruction->arguments[1];
+    bool previous = path && strcmp(path, "-") == 0;
+
+    if (!path)
+    {
+        path = variable_table_get(&state->variables, "HOME");
+    }
+    else if (previous)
+    {
+        path = variable_table_get(&state->variables, "OLDPWD");
+    }
+
+    if (!path || chdir(path) == -1)
     {
         fprintf(stderr, "Error: invalid directory\n");
+
+        state->status = 1;
+
+        return true;
+    }
+
+    euler_ok(parser_set_variable(state, "OLDPWD", state->workingDirectory));
+    euler_ok(parser_set_working_directory(state));
+
+    if (previous)
+    {
+        printf("%s\n", state->workingDirectory);
     }
 
+    state->status = 0;
+
     return true;
 }
@@ -0,0 +1,337 @@
+// command_table.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/access.2.html
+//  - https://www.man7.org/linux/man-pages/man3/getenv.3.html
+//  - https://www.man7.org/linux/man-pages/man2/stat.2.html
+//  - https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "command_table.h"
+#define COMMAND_TABLE_DEFAULT_PATH "/usr/bin"
+
+Exception command_table(CommandTable instance, size_t capacity)
+{
+    if (capacity < 16)
+    {
+        capacity = 16;
+    }
+
+    instance->buckets = calloc(capacity, sizeof * instance->buckets);
+
+    if (!instance->buckets)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->count = 0;
+    instance->capacity = capacity;
+    instance->searchPath = NULL;
+
+    return 0;
+}
+
+static size_t command_table_hash(String value)
+{
+    size_t result = 14695981039346656037ull;
+
+    for (unsigned char* p = (unsigned char*)value; *p; p++)
+    {
+        result ^= *p;
+        result *= 1099511628211ull;
+    }
+
+    return result;
+}
+
+static Exception command_table_validate(CommandTable instance)
+{
+    String searchPath = getenv("PATH");
+
+    if (!searchPath)
+    {
+        searchPath = COMMAND_TABLE_DEFAULT_PATH;
+    }
+
+    if (instance->searchPath && strcmp(instance->searchPath, searchPath) == 0)
+    {
+        return 0;
+    }
+
+    command_table_clear(instance);
+    free(instance->searchPath);
+
+    instance->searchPath = strdup(searchPath);
+
+    if (!instance->searchPath)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    return 0;
+}
+
+static Exception command_table_resolve(
+    String searchPath,
+    String name,
+    String* result)
+{
+    size_t nameLength = strlen(name);
+    String start = searchPath;
+
+    for (;;)
+    {
+        String end = strchr(start, ':');
+
+        if (!end)
+        {
+            end = start + strlen(start);
+        }
+
+        size_t length = end - start;
+        String candidate = malloc(length + nameLength + 3);
+
+        if (!candidate)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        if (length)
+        {
+            memcpy(candidate, start, length);
+        }
+        else
+        {
+            candidate[length++] = '.';
+        }
+
+        candidate[length] = '/';
+
+        memcpy(candidate + length + 1, name, nameLength + 1);
+
+        struct stat status;
+
+        if (stat(candidate, &status) == 0 &&
+            S_ISREG(status.st_mode) &&
+            access(candidate, X_OK) == 0)
+        {
+            *result = candidate;
+
+            return 0;
+        }
+
+        free(candidate);
+
+        if (!*end)
+        {
+            break;
+        }
+
+        start = end + 1;
+    }
+
+    *result = NULL;
+
+    return 0;
+}
+
+static Exception command_table_ensure_capacity(
+    CommandTable instance,
+    size_t capacity)
+{
+    if (instance->capacity >= capacity)
+    {
+        return 0;
+    }
+
+    size_t newCapacity = instance->capacity * 2;
+
+    if (capacity > newCapacity)
+    {
+        newCapacity = capacity;
+    }
+
+    CommandEntry* newBuckets = calloc(newCapacity, sizeof * newBuckets);
+
+    if (!newBuckets)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < instance->capacity; i++)
+    {
+        CommandEntry entry = instance->buckets[i];
+
+        while (entry)
+        {
+            CommandEntry next = entry->next;
+            size_t bucket = entry->hash % newCapacity;
+
+            entry->next = newBuckets[bucket];
+            newBuckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(instance->buckets);
+
+    instance->capacity = newCapacity;
+    instance->buckets = newBuckets;
+
+    return 0;
+}
+
+Exception command_table_find(
+    CommandTable instance,
+    String name,
+    String* result)
+{
+    if (strchr(name, '/'))
+    {
+        *result = name;
+
+        return 0;
+    }
+
+    Exception ex = command_table_validate(instance);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    size_t hash = command_table_hash(name);
+
+    for (CommandEntry entry = instance->buckets[hash % instance->capacity];
+        entry;
+        entry = entry->next)
+    {
+        if (entry->hash == hash && strcmp(entry->name, name) == 0)
+        {
+            entry->hits++;
+            *result = entry->path;
+
+            return 0;
+        }
+    }
+
+    String path;
+
+    ex = command_table_resolve(instance->searchPath, name, &path);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    if (!path)
+    {
+        *result = NULL;
+
+        return 0;
+    }
+
+    ex = command_table_ensure_capacity(instance, instance->count + 1);
+
+    if (ex)
+    {
+        free(path);
+
+        return ex;
+    }
+
+    CommandEntry entry = malloc(sizeof * entry);
+
+    if (!entry)
+    {
+        free(path);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    entry->name = strdup(name);
+
+    if (!entry->name)
+    {
+        free(entry);
+        free(path);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    size_t bucket = hash % instance->capacity;
+
+    entry->path = path;
+    entry->hash = hash;
+    entry->hits = 1;
+    entry->next = instance->buckets[bucket];
+    instance->buckets[bucket] = entry;
+    instance->count++;
+    *result = path;
+
+    return 0;
+}
+
+static void finalize_command_entry(CommandEntry instance)
+{
+    free(instance->name);
+    free(instance->path);
+    free(instance);
+}
+
+void command_table_remove(CommandTable instance, String name)
+{
+    size_t hash = command_table_hash(name);
+    CommandEntry* p = instance->buckets + hash % instance->capacity;
+
+    while (*p)
+    {
+        CommandEntry entry = *p;
+
+        if (entry->hash == hash && strcmp(entry->name, name) == 0)
+        {
+            *p = entry->next;
+
+            finalize_command_entry(entry);
+
+            instance->count--;
+
+            return;
+        }
+
+        p = &entry->next;
+    }
+}
+
+void command_table_clear(CommandTable instance)
+{
+    for (size_t i = 0; i < instance->capacity; i++)
+    {
+        while (instance->buckets[i])
+        {
+            CommandEntry next = instance->buckets[i]->next;
+
+            finalize_command_entry(instance->buckets[i]);
+
+            instance->buckets[i] = next;
+        }
+    }
+
+    instance->count = 0;
+}
+
+void finalize_command_table(CommandTable instance)
+{
+    command_table_clear(instance);
+    free(instance->buckets);
+    free(instance->searchPath);
+
+    instance->buckets = NULL;
+    instance->capacity = 0;
+    instance->searchPath = NULL;
+}
@@ -0,0 +1,44 @@
+// command_table.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.gnu.org/software/bash/manual/html_node/Bourne-Shell-Builtins.html
+
+#ifndef COMMAND_TABLE_38c7a740c8eb4950b2663163aa572981
+#define COMMAND_TABLE_38c7a740c8eb4950b2663163aa572981
+#include <stddef.h>
+#include "euler.h"
+
+struct CommandEntry
+{
+    char* name;
+    char* path;
+    size_t hash;
+    size_t hits;
+    struct CommandEntry* next;
+};
+
+struct CommandTable
+{
+    size_t count;
+    size_t capacity;
+    struct CommandEntry** buckets;
+    char* searchPath;
+};
+
+typedef struct CommandEntry* CommandEntry;
+typedef struct CommandTable* CommandTable;
+
+Exception command_table(CommandTable instance, size_t capacity);
+
+Exception command_table_find(
+    CommandTable instance,
+    String name,
+    String* result);
+
+void command_table_remove(CommandTable instance, String name);
+void command_table_clear(CommandTable instance);
+void finalize_command_table(CommandTable instance);
+
+#endif
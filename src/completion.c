@@ -0,0 +1,582 @@
+// completion.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/getdents64.2.html
+//  - https://www.man7.org/linux/man-pages/man2/faccessat.2.html
+//  - https://www.man7.org/linux/man-pages/man2/stat.2.html
+//  - https://en.wikipedia.org/wiki/Trie
+
+#define _GNU_SOURCE
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "completion.h"
+#define COMPLETION_BUFFER 32768
+#define COMPLETION_DEFAULT_PATH "/usr/bin"
+
+struct CompletionDirectory
+{
+    int descriptor;
+    ssize_t count;
+    ssize_t offset;
+    char buffer[COMPLETION_BUFFER];
+};
+
+typedef struct CompletionDirectory* CompletionDirectory;
+
+Exception completion(Completion instance)
+{
+    Exception ex = argument_vector(&instance->candidates, 0);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    instance->nodeCount = 0;
+    instance->nodeCapacity = 0;
+    instance->nodes = NULL;
+    instance->searchPath = NULL;
+    instance->directoryCount = 0;
+    instance->modified = NULL;
+
+    arena(&instance->arena, 0);
+
+    return 0;
+}
+
+static bool completion_open(CompletionDirectory instance, String path)
+{
+    instance->descriptor = open(path, O_CLOEXEC | O_DIRECTORY | O_RDONLY);
+    instance->count = 0;
+    instance->offset = 0;
+
+    return instance->descriptor != -1;
+}
+
+static struct dirent64* completion_next(CompletionDirectory instance)
+{
+    if (instance->offset >= instance->count)
+    {
+        instance->count = getdents64(
+            instance->descriptor,
+            instance->buffer,
+            sizeof instance->buffer);
+        instance->offset = 0;
+
+        if (instance->count <= 0)
+        {
+            return NULL;
+        }
+    }
+
+    struct dirent64* result = (struct dirent64*)
+        (instance->buffer + instance->offset);
+
+    instance->offset += result->d_reclen;
+
+    return result;
+}
+
+static void completion_close(CompletionDirectory instance)
+{
+    close(instance->descriptor);
+}
+
+static bool completion_is_directory(int directory, struct dirent64* entry)
+{
+    if (entry->d_type == DT_DIR)
+    {
+        return true;
+    }
+
+    if (entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN)
+    {
+        return false;
+    }
+
+    struct stat status;
+
+    return fstatat(directory, entry->d_name, &status, 0) == 0 &&
+        S_ISDIR(status.st_mode);
+}
+
+static Exception completion_add_node(Completion instance, uint32_t* result)
+{
+    if (instance->nodeCount == instance->nodeCapacity)
+    {
+        size_t newCapacity = instance->nodeCapacity * 2;
+
+        if (!newCapacity)
+        {
+            newCapacity = 1024;
+        }
+
+        TrieNode newNodes = realloc(
+            instance->nodes,
+            newCapacity * sizeof * newNodes);
+
+        if (!newNodes)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->nodeCapacity = newCapacity;
+        instance->nodes = newNodes;
+    }
+
+    TrieNode node = instance->nodes + instance->nodeCount;
+
+    node->child = 0;
+    node->next = 0;
+    node->key = 0;
+    node->terminal = false;
+    *result = instance->nodeCount;
+    instance->nodeCount++;
+
+    return 0;
+}
+
+static Exception completion_insert(Completion instance, String value)
+{
+    uint32_t current = 0;
+
+    for (unsigned char* p = (unsigned char*)value; *p; p++)
+    {
+        uint32_t* link = &instance->nodes[current].child;
+
+        while (*link && instance->nodes[*link].key < *p)
+        {
+            link = &instance->nodes[*link].next;
+        }
+
+        if (*link && instance->nodes[*link].key == *p)
+        {
+            current = *link;
+
+            continue;
+        }
+
+        uint32_t added;
+        ptrdiff_t offset = (char*)link - (char*)instance->nodes;
+        Exception ex = completion_add_node(instance, &added);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        link = (uint32_t*)((char*)instance->nodes + offset);
+
+        instance->nodes[added].key = *p;
+        instance->nodes[added].next = *link;
+        *link = added;
+        current = added;
+    }
+
+    instance->nodes[current].terminal = true;
+
+    return 0;
+}
+
+static String completion_search_path(void)
+{
+    String result = getenv("PATH");
+
+    if (!result)
+    {
+        return COMPLETION_DEFAULT_PATH;
+    }
+
+    return result;
+}
+
+static bool completion_is_current(Completion instance)
+{
+    String searchPath = completion_search_path();
+
+    if (!instance->searchPath ||
+        strcmp(instance->searchPath, searchPath) != 0)
+    {
+        return false;
+    }
+
+    String start = instance->searchPath;
+
+    for (size_t i = 0; i < instance->directoryCount; i++)
+    {
+        size_t length = strcspn(start, ":");
+        char path[length + 2];
+        struct stat status;
+
+        memcpy(path, start, length);
+
+        path[length] = '\0';
+
+        if (!length)
+        {
+            strcpy(path, ".");
+        }
+
+        struct timespec modified = { 0 };
+
+        if (stat(path, &status) == 0)
+        {
+            modified = status.st_mtim;
+        }
+
+        if (modified.tv_sec != instance->modified[i].tv_sec ||
+            modified.tv_nsec != instance->modified[i].tv_nsec)
+        {
+            return false;
+        }
+
+        start += length + 1;
+    }
+
+    return true;
+}
+
+static Exception completion_build(Completion instance)
+{
+    String searchPath = completion_search_path();
+    String newSearchPath = strdup(searchPath);
+
+    if (!newSearchPath)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    free(instance->searchPath);
+
+    instance->searchPath = newSearchPath;
+
+    size_t directoryCount = 1;
+
+    for (String p = searchPath; *p; p++)
+    {
+        if (*p == ':')
+        {
+            directoryCount++;
+        }
+    }
+
+    struct timespec* newModified = realloc(
+        instance->modified,
+        directoryCount * sizeof * newModified);
+
+    if (!newModified)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->modified = newModified;
+    instance->directoryCount = directoryCount;
+    instance->nodeCount = 0;
+
+    uint32_t root;
+    Exception ex = completion_add_node(instance, &root);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    CompletionDirectory directory = malloc(sizeof * directory);
+
+    if (!directory)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    String start = instance->searchPath;
+
+    for (size_t i = 0; i < directoryCount; i++)
+    {
+        size_t length = strcspn(start, ":");
+        char path[length + 2];
+
+        memcpy(path, start, length);
+
+        path[length] = '\0';
+
+        if (!length)
+        {
+            strcpy(path, ".");
+        }
+
+        start += length + 1;
+
+        struct stat status;
+
+        instance->modified[i] = (struct timespec) { 0 };
+
+        if (stat(path, &status) == 0)
+        {
+            instance->modified[i] = status.st_mtim;
+        }
+
+        if (!completion_open(directory, path))
+        {
+            continue;
+        }
+
+        struct dirent64* entry;
+
+        while ((entry = completion_next(directory)))
+        {
+            if (entry->d_name[0] == '.' ||
+                entry->d_type == DT_DIR ||
+                faccessat(directory->descriptor, entry->d_name, X_OK, 0) ||
+                completion_is_directory(directory->descriptor, entry))
+            {
+                continue;
+            }
+
+            ex = completion_insert(instance, entry->d_name);
+
+            if (ex)
+            {
+                completion_close(directory);
+                free(directory);
+
+                return ex;
+            }
+        }
+
+        completion_close(directory);
+    }
+
+    free(directory);
+
+    return 0;
+}
+
+static Exception completion_collect(
+    Completion instance,
+    uint32_t node,
+    String buffer,
+    size_t length,
+    size_t capacity)
+{
+    if (instance->nodes[node].terminal)
+    {
+        Exception ex = argument_vector_ensure_capacity(
+            &instance->candidates,
+            instance->candidates.count + 1);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        String candidate = arena_copy(&instance->arena, buffer, length);
+
+        if (!candidate)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->candidates.buffer[instance->candidates.count] = candidate;
+        instance->candidates.count++;
+        instance->candidates.buffer[instance->candidates.count] = NULL;
+    }
+
+    if (length + 1 >= capacity)
+    {
+        return 0;
+    }
+
+    for (uint32_t child = instance->nodes[node].child;
+        child;
+        child = instance->nodes[child].next)
+    {
+        buffer[length] = instance->nodes[child].key;
+
+        Exception ex = completion_collect(
+            instance,
+            child,
+            buffer,
+            length + 1,
+            capacity);
+
+        if (ex)
+        {
+            return ex;
+        }
+    }
+
+    return 0;
+}
+
+static Exception completion_find_command(
+    Completion instance,
+    String word,
+    size_t length)
+{
+    if (!completion_is_current(instance))
+    {
+        Exception ex = completion_build(instance);
+
+        if (ex)
+        {
+            return ex;
+        }
+    }
+
+    uint32_t node = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        uint32_t child = instance->nodes[node].child;
+
+        while (child && instance->nodes[child].key != (unsigned char)word[i])
+        {
+            child = instance->nodes[child].next;
+        }
+
+        if (!child)
+        {
+            return 0;
+        }
+
+        node = child;
+    }
+
+    char buffer[NAME_MAX + 1];
+
+    memcpy(buffer, word, length);
+
+    return completion_collect(instance, node, buffer, length, sizeof buffer);
+}
+
+static Exception completion_find_path(
+    Completion instance,
+    String word,
+    size_t length)
+{
+    size_t directoryLength = length;
+
+    while (directoryLength && word[directoryLength - 1] != '/')
+    {
+        directoryLength--;
+    }
+
+    String name = word + directoryLength;
+    size_t nameLength = length - directoryLength;
+    char path[directoryLength + 2];
+
+    memcpy(path, word, directoryLength);
+
+    path[directoryLength] = '\0';
+
+    if (!directoryLength)
+    {
+        strcpy(path, ".");
+    }
+
+    CompletionDirectory directory = malloc(sizeof * directory);
+
+    if (!directory)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    if (!completion_open(directory, path))
+    {
+        free(directory);
+
+        return 0;
+    }
+
+    Exception ex = 0;
+    struct dirent64* entry;
+
+    while ((entry = completion_next(directory)))
+    {
+        String entryName = entry->d_name;
+
+        if (strncmp(entryName, name, nameLength) != 0 ||
+            strcmp(entryName, ".") == 0 ||
+            strcmp(entryName, "..") == 0 ||
+            (entryName[0] == '.' && name[0] != '.'))
+        {
+            continue;
+        }
+
+        bool isDirectory = completion_is_directory(
+            directory->descriptor,
+            entry);
+        size_t entryLength = strlen(entryName);
+        String candidate = arena_allocate(
+            &instance->arena,
+            directoryLength + entryLength + 2);
+
+        ex = argument_vector_ensure_capacity(
+            &instance->candidates,
+            instance->candidates.count + 1);
+
+        if (!candidate)
+        {
+            ex = EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        if (ex)
+        {
+            break;
+        }
+
+        memcpy(candidate, word, directoryLength);
+        memcpy(candidate + directoryLength, entryName, entryLength);
+
+        candidate[directoryLength + entryLength] = '/';
+        candidate[directoryLength + entryLength + isDirectory] = '\0';
+        instance->candidates.buffer[instance->candidates.count] = candidate;
+        instance->candidates.count++;
+        instance->candidates.buffer[instance->candidates.count] = NULL;
+    }
+
+    completion_close(directory);
+    free(directory);
+
+    return ex;
+}
+
+Exception completion_find(
+    Completion instance,
+    String word,
+    size_t length,
+    bool command)
+{
+    argument_vector_clear(&instance->candidates);
+    arena_reset(&instance->arena);
+
+    if (command && !memchr(word, '/', length))
+    {
+        return completion_find_command(instance, word, length);
+    }
+
+    return completion_find_path(instance, word, length);
+}
+
+void finalize_completion(Completion instance)
+{
+    finalize_argument_vector(&instance->candidates);
+    finalize_arena(&instance->arena);
+    free(instance->nodes);
+    free(instance->searchPath);
+    free(instance->modified);
+
+    instance->nodes = NULL;
+    instance->nodeCount = 0;
+    instance->nodeCapacity = 0;
+    instance->searchPath = NULL;
+    instance->modified = NULL;
+    instance->directoryCount = 0;
+}
@@ -0,0 +1,50 @@
+// completion.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://en.wikipedia.org/wiki/Trie
+
+#ifndef COMPLETION_8b1f2d7c4e6a4f0b9a3c5d2e1f0a9b8c
+#define COMPLETION_8b1f2d7c4e6a4f0b9a3c5d2e1f0a9b8c
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "arena.h"
+#include "argument_vector.h"
+#include "euler.h"
+
+struct TrieNode
+{
+    uint32_t child;
+    uint32_t next;
+    unsigned char key;
+    bool terminal;
+};
+
+struct Completion
+{
+    size_t nodeCount;
+    size_t nodeCapacity;
+    struct TrieNode* nodes;
+    char* searchPath;
+    size_t directoryCount;
+    struct timespec* modified;
+    struct Arena arena;
+    struct ArgumentVector candidates;
+};
+
+typedef struct TrieNode* TrieNode;
+typedef struct Completion* Completion;
+
+Exception completion(Completion instance);
+
+Exception completion_find(
+    Completion instance,
+    String word,
+    size_t length,
+    bool command);
+
+void finalize_completion(Completion instance);
+
+#endif
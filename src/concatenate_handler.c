@@ -0,0 +1,77 @@
+// concatenate_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/cat.html
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "handler.h"
+#include "stream.h"
+
+bool concatenate_handler_accepts(Instruction instruction)
+{
+    for (size_t i = 1; i < instruction->length; i++)
+    {
+        String argument = instruction->arguments[i];
+
+        if (argument[0] == '-' && argument[1])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int concatenate_handler(
+    EULER_UNUSED Parser state,
+    Instruction instruction,
+    int input,
+    int output)
+{
+    if (instruction->length == 1)
+    {
+        return !stream_copy(input, output);
+    }
+
+    int result = 0;
+
+    for (size_t i = 1; i < instruction->length; i++)
+    {
+        String path = instruction->arguments[i];
+
+        if (strcmp(path, "-") == 0)
+        {
+            if (!stream_copy(input, output))
+            {
+                result = 1;
+            }
+
+            continue;
+        }
+
+        int descriptor = open(path, O_CLOEXEC | O_RDONLY);
+
+        if (descriptor == -1)
+        {
+            fprintf(stderr, "Error: invalid file\n");
+
+            result = 1;
+
+            continue;
+        }
+
+        if (!stream_copy(descriptor, output))
+        {
+            result = 1;
+        }
+
+        close(descriptor);
+    }
+
+    return result;
+}
@@ -0,0 +1,265 @@
+// directory_cache.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/getdents64.2.html
+//  - https://www.man7.org/linux/man-pages/man2/stat.2.html
+//  - https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+
+#define _GNU_SOURCE
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "directory_cache.h"
+#define DIRECTORY_CACHE_BUCKETS 64
+#define DIRECTORY_CACHE_BUFFER 32768
+
+void directory_cache(DirectoryCache instance, Arena arena)
+{
+    instance->arena = arena;
+    instance->capacity = DIRECTORY_CACHE_BUCKETS;
+    instance->buckets = NULL;
+}
+
+static size_t directory_cache_hash(String value)
+{
+    size_t result = 14695981039346656037ull;
+
+    for (unsigned char* p = (unsigned char*)value; *p; p++)
+    {
+        result ^= *p;
+        result *= 1099511628211ull;
+    }
+
+    return result;
+}
+
+static Exception directory_cache_read(
+    DirectoryCache instance,
+    Directory directory,
+    int descriptor)
+{
+    Arena arena = instance->arena;
+    char* buffer = malloc(DIRECTORY_CACHE_BUFFER);
+
+    if (!buffer)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    size_t capacity = 64;
+    DirectoryEntry entries = arena_allocate(arena, capacity * sizeof * entries);
+    size_t count = 0;
+    ssize_t length;
+
+    while (entries &&
+        (length = getdents64(descriptor, buffer, DIRECTORY_CACHE_BUFFER)) > 0)
+    {
+        for (ssize_t offset = 0; offset < length;)
+        {
+            struct dirent64* entry = (struct dirent64*)(buffer + offset);
+
+            offset += entry->d_reclen;
+
+            if (strcmp(entry->d_name, ".") == 0 ||
+                strcmp(entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+
+            if (count == capacity)
+            {
+                DirectoryEntry newEntries = arena_allocate(
+                    arena,
+                    capacity * 2 * sizeof * newEntries);
+
+                if (!newEntries)
+                {
+                    entries = NULL;
+
+                    break;
+                }
+
+                memcpy(newEntries, entries, count * sizeof * newEntries);
+
+                capacity *= 2;
+                entries = newEntries;
+            }
+
+            entries[count].name = arena_copy(
+                arena,
+                entry->d_name,
+                strlen(entry->d_name));
+            entries[count].type = entry->d_type;
+
+            if (!entries[count].name)
+            {
+                entries = NULL;
+
+                break;
+            }
+
+            count++;
+        }
+    }
+
+    free(buffer);
+
+    if (!entries)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    directory->count = count;
+    directory->entries = entries;
+
+    return 0;
+}
+
+Exception directory_cache_find(
+    DirectoryCache instance,
+    String path,
+    Directory* result)
+{
+    if (!instance->buckets)
+    {
+        instance->buckets = arena_allocate_zero(
+            instance->arena,
+            instance->capacity * sizeof * instance->buckets);
+
+        if (!instance->buckets)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+    }
+
+    size_t hash = directory_cache_hash(path);
+    Directory* bucket = instance->buckets + hash % instance->capacity;
+    Directory directory = *bucket;
+
+    while (directory &&
+        (directory->hash != hash || strcmp(directory->path, path) != 0))
+    {
+        directory = directory->next;
+    }
+
+    struct stat status;
+
+    if (directory)
+    {
+        if (stat(path, &status) == 0 &&
+            status.st_mtim.tv_sec == directory->modified.tv_sec &&
+            status.st_mtim.tv_nsec == directory->modified.tv_nsec)
+        {
+            *result = directory;
+
+            return 0;
+        }
+    }
+
+    *result = NULL;
+
+    int descriptor = open(path, O_CLOEXEC | O_DIRECTORY | O_RDONLY);
+
+    if (descriptor == -1)
+    {
+        return 0;
+    }
+
+    if (fstat(descriptor, &status) == -1)
+    {
+        close(descriptor);
+
+        return 0;
+    }
+
+    if (!directory)
+    {
+        directory = arena_allocate(instance->arena, sizeof * directory);
+
+        if (!directory)
+        {
+            close(descriptor);
+
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        directory->path = arena_copy(instance->arena, path, strlen(path));
+        directory->hash = hash;
+        directory->count = 0;
+        directory->entries = NULL;
+
+        if (!directory->path)
+        {
+            close(descriptor);
+
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        directory->next = *bucket;
+        *bucket = directory;
+    }
+
+    directory->modified = status.st_mtim;
+
+    Exception ex = directory_cache_read(instance, directory, descriptor);
+
+    close(descriptor);
+
+    if (ex)
+    {
+        directory->modified = (struct timespec) { 0 };
+
+        return ex;
+    }
+
+    *result = directory;
+
+    return 0;
+}
+
+bool directory_cache_is_directory(
+    Directory directory,
+    DirectoryEntry entry,
+    bool follow)
+{
+    if (entry->type == DT_DIR)
+    {
+        return true;
+    }
+
+    if (entry->type != DT_UNKNOWN && (!follow || entry->type != DT_LNK))
+    {
+        return false;
+    }
+
+    int descriptor = open(directory->path, O_CLOEXEC | O_DIRECTORY | O_RDONLY);
+
+    if (descriptor == -1)
+    {
+        return false;
+    }
+
+    struct stat status;
+    int flags = follow ? 0 : AT_SYMLINK_NOFOLLOW;
+    bool result = fstatat(descriptor, entry->name, &status, flags) == 0 &&
+        S_ISDIR(status.st_mode);
+
+    close(descriptor);
+
+    if (result && !follow)
+    {
+        entry->type = DT_DIR;
+    }
+
+    return result;
+}
+
+void directory_cache_clear(DirectoryCache instance)
+{
+    instance->buckets = NULL;
+}
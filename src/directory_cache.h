@@ -0,0 +1,56 @@
+// directory_cache.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/getdents64.2.html
+
+#ifndef DIRECTORY_CACHE_6f1b8c3d2a9e4d7b8c0e5a4f3d2b1c9e
+#define DIRECTORY_CACHE_6f1b8c3d2a9e4d7b8c0e5a4f3d2b1c9e
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "arena.h"
+#include "euler.h"
+
+struct DirectoryEntry
+{
+    char* name;
+    unsigned char type;
+};
+
+struct Directory
+{
+    char* path;
+    size_t hash;
+    struct timespec modified;
+    size_t count;
+    struct DirectoryEntry* entries;
+    struct Directory* next;
+};
+
+struct DirectoryCache
+{
+    Arena arena;
+    size_t capacity;
+    struct Directory** buckets;
+};
+
+typedef struct DirectoryEntry* DirectoryEntry;
+typedef struct Directory* Directory;
+typedef struct DirectoryCache* DirectoryCache;
+
+void directory_cache(DirectoryCache instance, Arena arena);
+
+Exception directory_cache_find(
+    DirectoryCache instance,
+    String path,
+    Directory* result);
+
+bool directory_cache_is_directory(
+    Directory directory,
+    DirectoryEntry entry,
+    bool follow);
+void directory_cache_clear(DirectoryCache instance);
+
+#endif
@@ -0,0 +1,193 @@
+// echo_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/echo.html
+//  - https://www.gnu.org/software/bash/manual/html_node/Bash-Builtins.html
+
+#include <stdio.h>
+#include <string.h>
+#include "handler.h"
+#include "stream.h"
+
+static bool echo_handler_is_option(String value)
+{
+    return value[0] == '-' && value[1] && !value[1 + strspn(value + 1, "neE")];
+}
+
+static unsigned char echo_handler_number(String* value, int base, int count)
+{
+    unsigned char result = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        char digit = **value;
+        int number;
+
+        if (digit >= '0' && digit <= '7')
+        {
+            number = digit - '0';
+        }
+        else if (base == 16 && digit >= '8' && digit <= '9')
+        {
+            number = digit - '0';
+        }
+        else if (base == 16 && digit >= 'a' && digit <= 'f')
+        {
+            number = digit - 'a' + 10;
+        }
+        else if (base == 16 && digit >= 'A' && digit <= 'F')
+        {
+            number = digit - 'A' + 10;
+        }
+        else
+        {
+            break;
+        }
+
+        result = result * base + number;
+        (*value)++;
+    }
+
+    return result;
+}
+
+// Escapes never lengthen the text, so they are decoded into the output
+// buffer in place. Returns false when \c ends the output.
+
+static bool echo_handler_escape(String value, char** result)
+{
+    char* p = *result;
+
+    while (*value)
+    {
+        if (*value != '\\' || !value[1])
+        {
+            *p = *value;
+            p++;
+            value++;
+
+            continue;
+        }
+
+        value += 2;
+
+        switch (value[-1])
+        {
+        case 'a': *p = '\a'; break;
+        case 'b': *p = '\b'; break;
+        case 'e': *p = '\033'; break;
+        case 'f': *p = '\f'; break;
+        case 'n': *p = '\n'; break;
+        case 'r': *p = '\r'; break;
+        case 't': *p = '\t'; break;
+        case 'v': *p = '\v'; break;
+        case '\\': *p = '\\'; break;
+        case '0': *p = echo_handler_number(&value, 8, 3); break;
+        case 'x':
+            if (!strchr("0123456789abcdefABCDEF", *value) || !*value)
+            {
+                p[0] = '\\';
+                p[1] = 'x';
+                p++;
+
+                break;
+            }
+
+            *p = echo_handler_number(&value, 16, 2);
+            break;
+
+        case 'c':
+            *result = p;
+
+            return false;
+
+        default:
+            p[0] = '\\';
+            p[1] = value[-1];
+            p++;
+            break;
+        }
+
+        p++;
+    }
+
+    *result = p;
+
+    return true;
+}
+
+int echo_handler(
+    Parser state,
+    Instruction instruction,
+    EULER_UNUSED int input,
+    int output)
+{
+    String* arguments = instruction->arguments;
+    size_t start = 1;
+    bool newline = true;
+    bool escape = false;
+
+    while (start < instruction->length &&
+        echo_handler_is_option(arguments[start]))
+    {
+        for (String p = arguments[start] + 1; *p; p++)
+        {
+            switch (*p)
+            {
+            case 'n': newline = false; break;
+            case 'e': escape = true; break;
+            default: escape = false; break;
+            }
+        }
+
+        start++;
+    }
+
+    size_t length = 0;
+
+    for (size_t i = start; i < instruction->length; i++)
+    {
+        length += strlen(arguments[i]) + 1;
+    }
+
+    char* buffer = arena_allocate(&state->arena, length + 1);
+
+    euler_assert(buffer);
+
+    char* p = buffer;
+
+    for (size_t i = start; i < instruction->length; i++)
+    {
+        if (escape && !echo_handler_escape(arguments[i], &p))
+        {
+            return !stream_write(output, buffer, p - buffer);
+        }
+
+        if (!escape)
+        {
+            size_t argumentLength = strlen(arguments[i]);
+
+            memcpy(p, arguments[i], argumentLength);
+
+            p += argumentLength;
+        }
+
+        *p = ' ';
+        p++;
+    }
+
+    if (p != buffer)
+    {
+        p--;
+    }
+
+    if (newline)
+    {
+        *p = '\n';
+        p++;
+    }
+
+    return !stream_write(output, buffer, p - buffer);
+}
@@ -4,9 +4,12 @@
 
 // References:
 //  - https://www.man7.org/linux/man-pages/man3/exec.3.html
+//  - https://www.man7.org/linux/man-pages/man2/fcntl.2.html
 //  - https://www.man7.org/linux/man-pages/man2/fork.2.html
 //  - https://www.man7.org/linux/man-pages/man2/open.2.html
 //  - https://www.man7.org/linux/man-pages/man2/pipe.2.html
+//  - https://www.man7.org/linux/man-pages/man2/F_SETPIPE_SZ.2const.html
+//  - https://www.man7.org/linux/man-pages/man3/posix_spawn.3.html
 //  - https://www.man7.org/linux/man-pages/man3/stdin.3.html
 //  - https://www.man7.org/linux/man-pages/man2/wait.2.html
 //  - https://www.gnu.org/software/libc/manual/html_node/Permission-Bits.html
@@ -14,188 +17,996 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <ctype.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include "expansion.h"
 #include "handler.h"
-#define EXECUTE_HANDLER_PREFIX "/usr/bin/"
-#define EXECUTE_HANDLER_PREFIX_LENGTH 9
+#include "stream.h"
+#include "trace.h"
+#define EXECUTE_HANDLER_PIPE_SIZE "NYUSH_PIPE_SIZE"
+#define EXECUTE_HANDLER_SIGNALS_LENGTH 6
 
-static void execute_handler_finalize_descriptors(Instruction first)
+static const int EXECUTE_HANDLER_SIGNALS[] =
 {
-    for (Instruction p = first->nextPipe; p; p = p->nextPipe)
+    SIGINT,
+    SIGPIPE,
+    SIGQUIT,
+    SIGTSTP,
+    SIGTTIN,
+    SIGTTOU
+};
+
+static void execute_handler_close_on_exec(int descriptor)
+{
+    euler_assert(fcntl(descriptor, F_SETFD, FD_CLOEXEC) != -1);
+}
+
+// The shell blocks signals only around sections such as the parallel pool,
+// so children always start with an empty mask.
+
+static void execute_handler_prepare_child(int descriptors[])
+{
+    sigset_t mask;
+
+    for (size_t i = 0; i < EXECUTE_HANDLER_SIGNALS_LENGTH; i++)
+    {
+        signal(EXECUTE_HANDLER_SIGNALS[i], SIG_DFL);
+    }
+
+    sigemptyset(&mask);
+    euler_assert(sigprocmask(SIG_SETMASK, &mask, NULL) != -1);
+
+    for (int i = 0; i < EXECUTE_HANDLER_DESCRIPTORS; i++)
     {
-        euler_assert(close(p->descriptors[0]) != -1);
-        euler_assert(close(p->descriptors[1]) != -1);
+        if (descriptors[i] == -1)
+        {
+            close(i);
+        }
+        else if (descriptors[i] != i)
+        {
+            euler_assert(dup2(descriptors[i], i) != -1);
+        }
     }
 }
 
-static void execute_handler_finalize_arguments(String values[])
+#ifdef EXECUTE_HANDLER_FORK
+static int execute_handler_spawn(
+    pid_t* result,
+    String path,
+    String arguments[],
+    String environment[],
+    int descriptors[],
+    pid_t group)
 {
-    for (String* p = values; *p; p++)
+    int report[2];
+
+    euler_assert(pipe(report) != -1);
+    execute_handler_close_on_exec(report[0]);
+    execute_handler_close_on_exec(report[1]);
+
+    pid_t pid = fork();
+
+    euler_assert(pid >= 0);
+
+    if (group != -1)
     {
-        free(*p);
+        setpgid(pid, group ? group : pid);
     }
 
-    free(values);
-}
+    if (!pid)
+    {
+        trace_fork();
+        execute_handler_prepare_child(descriptors);
+        execve(path, arguments, environment);
 
-static bool execute_handler_run(
-    JobCollection jobs,
-    Instruction first,
-    Instruction current)
+        int error = errno;
+
+        euler_assert(write(report[1], &error, sizeof error) == sizeof error);
+        _exit(EXIT_FAILURE);
+    }
+
+    int error = 0;
+
+    euler_assert(close(report[1]) != -1);
+
+    if (read(report[0], &error, sizeof error) == sizeof error)
+    {
+        euler_assert(waitpid(pid, NULL, 0) != -1);
+    }
+
+    euler_assert(close(report[0]) != -1);
+
+    *result = pid;
+
+    return error;
+}
+#else
+static int execute_handler_spawn(
+    pid_t* result,
+    String path,
+    String arguments[],
+    String environment[],
+    int descriptors[],
+    pid_t group)
 {
-    String* arguments = malloc((current->length + 1) * sizeof * arguments);
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attributes;
+    sigset_t defaults;
+    sigset_t mask;
+
+    euler_assert(posix_spawn_file_actions_init(&actions) == 0);
+    euler_assert(posix_spawnattr_init(&attributes) == 0);
+    sigemptyset(&defaults);
 
-    euler_assert(arguments);
+    for (size_t i = 0; i < EXECUTE_HANDLER_SIGNALS_LENGTH; i++)
+    {
+        sigaddset(&defaults, EXECUTE_HANDLER_SIGNALS[i]);
+    }
+
+    euler_assert(posix_spawnattr_setsigdefault(&attributes, &defaults) == 0);
+    sigemptyset(&mask);
+    euler_assert(posix_spawnattr_setsigmask(&attributes, &mask) == 0);
+    short flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
 
-    for (size_t i = 0; i < current->length; i++)
+    if (group != -1)
     {
-        arguments[i] = strdup(current->payload.arguments[i]);
+        flags |= POSIX_SPAWN_SETPGROUP;
 
-        euler_assert(arguments[i]);
+        euler_assert(posix_spawnattr_setpgroup(&attributes, group) == 0);
     }
 
-    arguments[current->length] = NULL;
+    euler_assert(posix_spawnattr_setflags(&attributes, flags) == 0);
 
+    for (int i = 0; i < EXECUTE_HANDLER_DESCRIPTORS; i++)
+    {
+        if (descriptors[i] == -1)
+        {
+            euler_assert(posix_spawn_file_actions_addclose(
+                &actions,
+                i) == 0);
+        }
+        else if (descriptors[i] != i)
+        {
+            euler_assert(posix_spawn_file_actions_adddup2(
+                &actions,
+                descriptors[i],
+                i) == 0);
+        }
+    }
+
+    int error = posix_spawn(
+        result,
+        path,
+        &actions,
+        &attributes,
+        arguments,
+        environment);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+
+    return error;
+}
+#endif
+
+static pid_t execute_handler_fork(
+    Parser state,
+    Builtin builtin,
+    Instruction current,
+    int descriptors[],
+    pid_t group,
+    int sibling)
+{
+    fflush(stdout);
+
+    uint64_t start = trace_now();
     pid_t pid = fork();
 
     euler_assert(pid >= 0);
 
+    if (group != -1)
+    {
+        setpgid(pid, group ? group : pid);
+    }
+
     if (pid)
     {
-        execute_handler_finalize_arguments(arguments);
+        trace_event(TRACE_FORK, start, pid, 0, builtin ? builtin->name : NULL);
 
-        int status;
+        return pid;
+    }
 
-        euler_assert(waitpid(pid, &status, WUNTRACED) != -1);
+    trace_fork();
 
-        if (WIFSTOPPED(status))
-        {
-            euler_ok(job_collection_add(jobs, pid, first));
-        }
+    if (sibling != STDIN_FILENO)
+    {
+        close(sibling);
+    }
 
-        return true;
+    execute_handler_prepare_child(descriptors);
+
+    state->jobs.subshell = true;
+    state->jobs.terminal = -1;
+
+    if (builtin)
+    {
+        int status = builtin->execute(
+            state,
+            current,
+            STDIN_FILENO,
+            STDOUT_FILENO);
+
+        trace_flush();
+        _exit(status);
     }
 
-    signal(SIGTSTP, SIG_DFL);
+    parser_execute(state, current->left);
+    fflush(stdout);
+    trace_flush();
+    _exit(state->status);
+}
 
-    if (current->write)
+static int execute_handler_open(Redirection value)
+{
+    switch (value->type)
     {
-        int descriptor = creat(current->write, S_IRUSR | S_IWUSR);
+    case REDIRECTION_READ:
+        return open(value->target, O_CLOEXEC | O_RDONLY);
+
+    case REDIRECTION_WRITE:
+        return open(
+            value->target,
+            O_CLOEXEC | O_CREAT | O_TRUNC | O_WRONLY,
+            S_IRUSR | S_IWUSR);
+
+    case REDIRECTION_APPEND:
+        return open(
+            value->target,
+            O_APPEND | O_CLOEXEC | O_CREAT | O_WRONLY,
+            S_IRUSR | S_IWUSR);
 
-        euler_assert(descriptor != -1);
-        euler_assert(dup2(descriptor, STDOUT_FILENO) != -1);
-        euler_assert(close(descriptor) != -1);
+    case REDIRECTION_DOCUMENT:
+    case REDIRECTION_STRING:
+        return stream_document(value->target, strlen(value->target));
+
+    default: break;
     }
-    else if (current->append)
+
+    if (strcmp(value->target, "-") == 0)
     {
-        int descriptor = open(
-            current->append,
-            O_APPEND | O_CREAT | O_WRONLY,
-            S_IRUSR | S_IWUSR);
+        return -1;
+    }
+
+    char* end;
+    long result = strtol(value->target, &end, 10);
+
+    if (!isdigit((unsigned char)value->target[0]) ||
+        *end ||
+        result >= EXECUTE_HANDLER_DESCRIPTORS)
+    {
+        errno = EBADF;
+
+        return -1;
+    }
+
+    return result;
+}
 
-        euler_assert(descriptor != -1);
-        euler_assert(dup2(descriptor, STDOUT_FILENO) != -1);
-        euler_assert(close(descriptor) != -1);
+static bool execute_handler_redirect(
+    Instruction current,
+    int descriptors[],
+    int opened[],
+    size_t* openedCount)
+{
+    if (!current)
+    {
+        return true;
     }
 
-    if (current->read)
+    for (Redirection p = current->redirections; p; p = p->next)
     {
-        int descriptor = open(current->read, O_RDONLY, S_IRUSR);
+        errno = 0;
+
+        int descriptor = execute_handler_open(p);
+
+        if (p->type != REDIRECTION_DUPLICATE)
+        {
+            if (descriptor == -1)
+            {
+                fprintf(stderr, "Error: invalid file\n");
+
+                return false;
+            }
 
-        if (descriptor == -1)
+            opened[*openedCount] = descriptor;
+            (*openedCount)++;
+        }
+        else if (descriptor != -1)
+        {
+            descriptor = descriptors[descriptor];
+        }
+        else if (errno)
         {
-            execute_handler_finalize_arguments(arguments);
             fprintf(stderr, "Error: invalid file\n");
 
             return false;
         }
 
-        euler_assert(dup2(descriptor, STDIN_FILENO) != -1);
-        euler_assert(close(descriptor) != -1);
+        descriptors[p->descriptor] = descriptor;
+    }
+
+    return true;
+}
+
+static void execute_handler_isolate(
+    int descriptors[],
+    int opened[],
+    size_t* openedCount)
+{
+    for (int i = 0; i < EXECUTE_HANDLER_DESCRIPTORS; i++)
+    {
+        int source = descriptors[i];
+
+        if (source == i ||
+            source < 0 ||
+            source >= EXECUTE_HANDLER_DESCRIPTORS ||
+            descriptors[source] == source)
+        {
+            continue;
+        }
+
+        int copy = fcntl(source, F_DUPFD_CLOEXEC, EXECUTE_HANDLER_DESCRIPTORS);
+
+        euler_assert(copy != -1);
+
+        opened[*openedCount] = copy;
+        (*openedCount)++;
+
+        for (int j = i; j < EXECUTE_HANDLER_DESCRIPTORS; j++)
+        {
+            if (descriptors[j] == source)
+            {
+                descriptors[j] = copy;
+            }
+        }
+    }
+}
+
+static void execute_handler_finalize_redirect(
+    int input,
+    int output,
+    int sink)
+{
+    if (input != STDIN_FILENO)
+    {
+        euler_assert(close(input) != -1);
+    }
+
+    if (output != sink)
+    {
+        euler_assert(close(output) != -1);
     }
+}
 
-    if (strchr(arguments[0], '/'))
+static String* execute_handler_environment(
+    Parser state,
+    Instruction current)
+{
+    VariableTable variables = &state->variables;
+
+    if (!current->assignmentCount)
     {
-        execv(arguments[0], arguments);
+        return variables->environment;
+    }
+
+    size_t count = variables->exportCount;
+    String* result = arena_allocate(
+        &state->arena,
+        (count + current->assignmentCount + 1) * sizeof * result);
+
+    euler_assert(result);
+    memcpy(result, variables->environment, count * sizeof * result);
+
+    for (size_t i = 0; i < current->assignmentCount; i++)
+    {
+        String variable = current->variables[i];
+        size_t length = strchr(variable, '=') - variable + 1;
+        Variable entry = variable_table_find(variables, variable, length - 1);
+
+        if (entry && entry->exported)
+        {
+            result[entry->slot] = variable;
+
+            continue;
+        }
+
+        size_t j = variables->exportCount;
+
+        while (j < count && strncmp(result[j], variable, length) != 0)
+        {
+            j++;
+        }
+
+        result[j] = variable;
+
+        if (j == count)
+        {
+            count++;
+        }
+    }
+
+    result[count] = NULL;
+
+    return result;
+}
+
+// The sibling descriptor is the shell's end of a pipe that the child uses:
+// the read end into the next stage, the pool's end of a parallel task's
+// output, or the shell's end of a process substitution. A forked child
+// closes it, or it would never see end of file or EPIPE once the other side
+// goes away. Standard input means there is none. Spawned programs never see it,
+// since it is close-on-exec.
+
+pid_t execute_handler_run(
+    Parser state,
+    Instruction current,
+    int descriptors[],
+    pid_t group,
+    int sibling)
+{
+    if (current->type == INSTRUCTION_SUBSHELL)
+    {
+        return execute_handler_fork(
+            state,
+            NULL,
+            current,
+            descriptors,
+            group,
+            sibling);
+    }
+
+    if (!current->length)
+    {
+        return 0;
+    }
+
+    String name = current->arguments[0];
+    Builtin builtin = builtin_handler_find(current);
+
+    if (builtin)
+    {
+        return execute_handler_fork(
+            state,
+            builtin,
+            current,
+            descriptors,
+            group,
+            sibling);
+    }
+
+    String path;
+    uint64_t start = trace_now();
+
+    euler_ok(command_table_find(&state->commands, name, &path));
+    trace_event(TRACE_LOOKUP, start, path != NULL, 0, name);
+
+    if (!path)
+    {
+        fprintf(stderr, "Error: invalid program\n");
+
+        return -1;
+    }
+
+    String* arguments = current->arguments;
+    String* environment = execute_handler_environment(state, current);
+    pid_t pid = -1;
+
+    start = trace_now();
+
+    trace_event(TRACE_SPAWN, 0, 0, 0, path);
+
+    int error = execute_handler_spawn(
+        &pid,
+        path,
+        arguments,
+        environment,
+        descriptors,
+        group);
+
+    if (error && path != name)
+    {
+        command_table_remove(&state->commands, name);
+        euler_ok(command_table_find(&state->commands, name, &path));
+
+        error = ENOENT;
+
+        if (path)
+        {
+            error = execute_handler_spawn(
+                &pid,
+                path,
+                arguments,
+                environment,
+                descriptors,
+                group);
+        }
+    }
+
+    if (error)
+    {
+        pid = -1;
+    }
+
+    trace_event(TRACE_EXEC, start, pid, error, path);
+
+    if (error)
+    {
+        fprintf(stderr, "Error: invalid program\n");
+
+        return -1;
+    }
+
+    return pid;
+}
+
+// The shell keeps its end of a process substitution open, without
+// close-on-exec and above the redirectable range, until the command that
+// names it has been launched. The child is waited for once that command
+// finishes.
+
+int execute_handler_substitute(Parser state, Substitution value)
+{
+    int channel[2];
+    int descriptors[EXECUTE_HANDLER_DESCRIPTORS];
+
+    euler_assert(pipe(channel) != -1);
+    execute_handler_close_on_exec(channel[0]);
+    execute_handler_close_on_exec(channel[1]);
+
+    for (int i = 0; i < EXECUTE_HANDLER_DESCRIPTORS; i++)
+    {
+        descriptors[i] = i;
+    }
+
+    int local = channel[0];
+    int remote = channel[1];
+
+    if (value->type == SUBSTITUTION_OUTPUT)
+    {
+        local = channel[1];
+        remote = channel[0];
+        descriptors[STDIN_FILENO] = remote;
     }
     else
     {
-        execv(arguments[0], arguments);
+        descriptors[STDOUT_FILENO] = remote;
+    }
+
+    pid_t pid = execute_handler_run(
+        state,
+        value->instruction,
+        descriptors,
+        -1,
+        local);
+
+    euler_assert(close(remote) != -1);
+
+    if (pid > 0)
+    {
+        euler_ok(parser_add_process(state, pid));
+    }
+
+    int result = fcntl(local, F_DUPFD, EXECUTE_HANDLER_DESCRIPTORS);
 
-        size_t length = strlen(arguments[0]);
-        size_t totalLength = EXECUTE_HANDLER_PREFIX_LENGTH + length;
-        String path = malloc(totalLength + 1);
+    euler_assert(result != -1);
+    euler_assert(close(local) != -1);
+    euler_ok(parser_add_descriptor(state, result));
 
-        euler_assert(path);
-        memcpy(path, EXECUTE_HANDLER_PREFIX, EXECUTE_HANDLER_PREFIX_LENGTH);
-        memcpy(path + EXECUTE_HANDLER_PREFIX_LENGTH, arguments[0], length);
+    return result;
+}
 
-        path[totalLength] = '\0';
+static bool execute_handler_is_passthrough(Instruction value)
+{
+    return value->type == INSTRUCTION_COMMAND &&
+        value->wordCount == 1 &&
+        strcmp(value->words[0], "cat") == 0;
+}
 
-        execv(path, arguments);
-        free(path);
+static bool execute_handler_is_file(
+    Instruction value,
+    int descriptor,
+    RedirectionType type)
+{
+    Redirection item = value->redirections;
+
+    return item &&
+        !item->next &&
+        item->descriptor == descriptor &&
+        (item->type == type ||
+            (type == REDIRECTION_WRITE && item->type == REDIRECTION_APPEND));
+}
+
+static bool execute_handler_is_regular(int descriptor)
+{
+    struct stat status;
+
+    return fstat(descriptor, &status) != -1 && S_ISREG(status.st_mode);
+}
+
+static Builtin execute_handler_find_inline(
+    Instruction instruction,
+    int descriptors[])
+{
+    Instruction value = instruction->stages[0];
+
+    if (instruction->stageCount != 1 ||
+        instruction->background ||
+        value->type != INSTRUCTION_COMMAND ||
+        !value->length ||
+        descriptors[STDIN_FILENO] == -1 ||
+        descriptors[STDOUT_FILENO] == -1)
+    {
+        return NULL;
     }
 
-    execute_handler_finalize_arguments(arguments);
-    fprintf(stderr, "Error: invalid program\n");
+    for (int i = STDERR_FILENO; i < EXECUTE_HANDLER_DESCRIPTORS; i++)
+    {
+        if (descriptors[i] != i)
+        {
+            return NULL;
+        }
+    }
+
+    Builtin result = builtin_handler_find(value);
 
-    return false;
+    if (!result || !result->input)
+    {
+        return result;
+    }
+
+    // The shell ignores Ctrl-C and Ctrl-Z, so it only copies data itself
+    // when both ends are regular files and the copy is bound to finish.
+
+    if (value->length == 1 &&
+        execute_handler_is_regular(descriptors[STDIN_FILENO]) &&
+        execute_handler_is_regular(descriptors[STDOUT_FILENO]))
+    {
+        return result;
+    }
+
+    return NULL;
+}
+
+static int execute_handler_call(
+    Parser state,
+    Instruction instruction,
+    Builtin builtin,
+    int descriptors[])
+{
+    fflush(stdout);
+
+    int result = builtin->execute(
+        state,
+        instruction,
+        descriptors[STDIN_FILENO],
+        descriptors[STDOUT_FILENO]);
+
+    return result << 8;
 }
 
-bool execute_handler(JobCollection jobs, Instruction instruction)
+static void execute_handler_elide(
+    Instruction stages[],
+    bool passthrough[],
+    size_t count)
 {
-    if (!instruction->nextPipe)
+    size_t first = count;
+    size_t last = 0;
+
+    for (size_t i = 0; i < count; i++)
     {
-        return execute_handler_run(jobs, instruction, instruction);
+        passthrough[i] = execute_handler_is_passthrough(stages[i]) &&
+            !stages[i]->redirections;
+
+        if (!execute_handler_is_passthrough(stages[i]))
+        {
+            if (first == count)
+            {
+                first = i;
+            }
+
+            last = i;
+        }
     }
 
-    for (Instruction p = instruction->nextPipe; p; p = p->nextPipe)
+    if (first == count)
     {
-        euler_assert(pipe(p->descriptors) != -1);
+        memset(passthrough, 0, count * sizeof * passthrough);
+
+        return;
     }
 
-    for (Instruction p = instruction; p; p = p->nextPipe)
+    passthrough[0] = first &&
+        execute_handler_is_file(stages[0], STDIN_FILENO, REDIRECTION_READ);
+    passthrough[count - 1] = last + 1 < count &&
+        execute_handler_is_file(
+            stages[count - 1],
+            STDOUT_FILENO,
+            REDIRECTION_WRITE);
+
+    size_t i = 1;
+
+    while (i < count && passthrough[i])
     {
-        pid_t pid = fork();
+        i++;
+    }
+
+    if (i < count && stages[i]->redirections)
+    {
+        passthrough[0] = false;
+    }
 
-        euler_assert(pid >= 0);
+    i = count - 1;
 
-        if (pid)
+    while (i && passthrough[i - 1])
+    {
+        i--;
+    }
+
+    if (i && stages[i - 1]->redirections)
+    {
+        passthrough[count - 1] = false;
+    }
+}
+
+static void execute_handler_pipeline(
+    Parser state,
+    Instruction instruction,
+    int sink)
+{
+    size_t descriptorCount = state->descriptorCount;
+    size_t processCount = state->processCount;
+    size_t count = instruction->stageCount;
+    Instruction* stages = instruction->stages;
+    size_t redirections = 2 * EXECUTE_HANDLER_DESCRIPTORS;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        euler_ok(expansion_expand(state, stages[i]));
+
+        for (Redirection p = stages[i]->redirections; p; p = p->next)
+        {
+            redirections++;
+        }
+    }
+
+    Arena arena = &state->arena;
+    bool* passthrough = arena_allocate_zero(arena, count * sizeof(bool));
+    pid_t* pids = arena_allocate_zero(arena, count * sizeof * pids);
+    int* statuses = arena_allocate_zero(arena, count * sizeof * statuses);
+    struct rusage* usages = arena_allocate(arena, count * sizeof * usages);
+    int* opened = arena_allocate(arena, redirections * sizeof * opened);
+
+    euler_assert(passthrough);
+    euler_assert(pids);
+    euler_assert(statuses);
+    euler_assert(usages);
+    euler_assert(opened);
+
+    String pipeSize = variable_table_get(
+        &state->variables,
+        EXECUTE_HANDLER_PIPE_SIZE);
+    size_t capacity = 0;
+
+    if (pipeSize)
+    {
+        capacity = strtoull(pipeSize, NULL, 10);
+
+        if (count > 1)
+        {
+            execute_handler_elide(stages, passthrough, count);
+        }
+    }
+
+    int input = STDIN_FILENO;
+    size_t first = 0;
+    size_t last = count;
+    pid_t group = 0;
+
+    if (state->jobs.subshell)
+    {
+        group = -1;
+    }
+
+    while (first < count && passthrough[first])
+    {
+        first++;
+    }
+
+    while (last && passthrough[last - 1])
+    {
+        last--;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (passthrough[i])
         {
             continue;
         }
 
-        signal(SIGTSTP, SIG_DFL);
+        int output = sink;
+        int next = STDIN_FILENO;
+
+        if (i + 1 < last)
+        {
+            int descriptors[2];
+
+            euler_assert(pipe(descriptors) != -1);
+            execute_handler_close_on_exec(descriptors[0]);
+            execute_handler_close_on_exec(descriptors[1]);
+            stream_set_capacity(descriptors[1], capacity);
+
+            output = descriptors[1];
+            next = descriptors[0];
+        }
+
+        int descriptors[EXECUTE_HANDLER_DESCRIPTORS];
+        size_t openedCount = 0;
+        Instruction before = NULL;
+        Instruction after = NULL;
+
+        for (int j = 0; j < EXECUTE_HANDLER_DESCRIPTORS; j++)
+        {
+            descriptors[j] = j;
+        }
+
+        descriptors[STDIN_FILENO] = input;
+        descriptors[STDOUT_FILENO] = output;
+
+        if (i == first && first)
+        {
+            before = stages[0];
+        }
+
+        if (i + 1 == last && last < count)
+        {
+            after = stages[count - 1];
+        }
 
-        if (p != instruction)
+        pids[i] = -1;
+
+        if (execute_handler_redirect(
+                before,
+                descriptors,
+                opened,
+                &openedCount) &&
+            execute_handler_redirect(
+                stages[i],
+                descriptors,
+                opened,
+                &openedCount) &&
+            execute_handler_redirect(
+                after,
+                descriptors,
+                opened,
+                &openedCount))
         {
-            euler_assert(dup2(p->descriptors[0], STDIN_FILENO) != -1);
+            Builtin builtin = execute_handler_find_inline(
+                instruction,
+                descriptors);
+
+            if (builtin)
+            {
+                statuses[i] = execute_handler_call(
+                    state,
+                    stages[i],
+                    builtin,
+                    descriptors);
+                pids[i] = 0;
+            }
+            else
+            {
+                execute_handler_isolate(descriptors, opened, &openedCount);
+
+                pids[i] = execute_handler_run(
+                    state,
+                    stages[i],
+                    descriptors,
+                    group,
+                    next);
+            }
         }
 
-        if (p->nextPipe)
+        if (pids[i] > 0 && !group)
         {
-            int descriptor = p->nextPipe->descriptors[1];
+            group = pids[i];
+        }
 
-            euler_assert(dup2(descriptor, STDOUT_FILENO) != -1);
+        for (size_t j = 0; j < openedCount; j++)
+        {
+            euler_assert(close(opened[j]) != -1);
         }
 
-        execute_handler_finalize_descriptors(instruction);
-        execute_handler_run(jobs, instruction, p);
+        execute_handler_finalize_redirect(input, output, sink);
 
-        return false;
+        input = next;
     }
 
-    execute_handler_finalize_descriptors(instruction);
+    parser_close_descriptors(state, descriptorCount);
+
+    struct Job item;
+
+    job(&item, instruction->text, pids, statuses, usages, count);
+
+    size_t id;
+
+    // A job left running or stopped may still be using its process
+    // substitutions, so the shell reaps them later with the other children.
 
-    for (Instruction p = instruction; p; p = p->nextPipe)
+    if (instruction->background && item.running)
     {
-        wait(NULL);
+        state->processCount = processCount;
+        state->status = 0;
+
+        euler_ok(job_collection_add(&state->jobs, &item, &id));
+        printf("[%zu] %d\n", id, item.group);
+
+        return;
     }
 
+    job_collection_wait(&state->jobs, &item);
+    euler_ok(parser_set_status(state, &item));
+
+    if (item.state == JOB_STATE_STOPPED)
+    {
+        state->processCount = processCount;
+
+        euler_ok(job_collection_add(&state->jobs, &item, &id));
+    }
+}
+
+bool execute_handler(Parser state, Instruction instruction)
+{
+    execute_handler_pipeline(state, instruction, STDOUT_FILENO);
+
     return true;
 }
+
+// Command substitution runs the pipeline with its standard output in an
+// anonymous memory file, so neither side blocks on a full pipe, and reads it
+// back in one pass once the job has finished. A lone built-in command writes
+// there directly without a fork.
+
+String execute_handler_capture(Parser state, Instruction instruction)
+{
+    int sink = stream_memory();
+    struct stat status;
+
+    euler_assert(sink != -1);
+    execute_handler_pipeline(state, instruction, sink);
+    euler_assert(fstat(sink, &status) != -1);
+
+    String result = arena_allocate(&state->arena, status.st_size + 1);
+
+    euler_assert(result);
+
+    size_t length = stream_read(sink, result, status.st_size);
+
+    euler_assert(close(sink) != -1);
+
+    while (length && result[length - 1] == '\n')
+    {
+        length--;
+    }
+
+    result[length] = '\0';
+
+    return result;
+}
@@ -4,15 +4,25 @@
 
 #include "handler.h"
 
-bool exit_handler(
-    JobCollection jobs, 
-    EULER_UNUSED Instruction instruction)
+bool exit_handler(Parser state, EULER_UNUSED Instruction instruction)
 {
-    if (jobs->count)
+    JobCollection jobs = &state->jobs;
+
+    if (jobs->terminal == -1 || jobs->subshell)
     {
-        fprintf(stderr, "Error: there are suspended jobs\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < jobs->end; i++)
+    {
+        if (jobs->items[i].text && jobs->items[i].state == JOB_STATE_STOPPED)
+        {
+            fprintf(stderr, "Error: there are suspended jobs\n");
+
+            state->status = 1;
 
-        return true;
+            return true;
+        }
     }
 
     return false;
@@ -0,0 +1,1091 @@
+// expansion.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+//  - https://www.man7.org/linux/man-pages/man3/qsort.3.html
+
+#include <sys/stat.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "expansion.h"
+#include "handler.h"
+#include "pattern.h"
+#define EXPANSION_DELIMITERS " \t\n"
+#define EXPANSION_SPECIAL "'\"\\$*?[`"
+#define EXPANSION_GLOB "*?["
+#define EXPANSION_ESCAPED "*?[]\\"
+#define EXPANSION_DOCUMENT "$\\`"
+#define EXPANSION_DESCRIPTOR "/dev/fd/%d"
+#define EXPANSION_PIPE_STATUS "PIPESTATUS"
+
+struct Expansion
+{
+    Parser state;
+    Instruction instruction;
+    size_t length;
+    size_t capacity;
+    char* buffer;
+    bool started;
+    bool split;
+    bool glob;
+    bool escaped;
+    size_t count;
+    size_t fieldCapacity;
+    char** fields;
+    char number[24];
+};
+
+typedef struct Expansion* Expansion;
+
+static Exception expansion_write(
+    Expansion instance,
+    String value,
+    size_t length)
+{
+    instance->started = true;
+
+    if (!length)
+    {
+        return 0;
+    }
+
+    if (instance->length + length > instance->capacity)
+    {
+        size_t newCapacity = instance->capacity * 2;
+
+        if (instance->length + length > newCapacity)
+        {
+            newCapacity = instance->length + length;
+        }
+
+        String newBuffer = realloc(instance->buffer, newCapacity);
+
+        if (!newBuffer)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->capacity = newCapacity;
+        instance->buffer = newBuffer;
+    }
+
+    memcpy(instance->buffer + instance->length, value, length);
+
+    instance->length += length;
+
+    return 0;
+}
+
+static Exception expansion_append(
+    Expansion instance,
+    String value,
+    size_t length,
+    bool quoted)
+{
+    instance->started = true;
+
+    if (!instance->split)
+    {
+        return expansion_write(instance, value, length);
+    }
+
+    String special = quoted ? EXPANSION_ESCAPED : EXPANSION_GLOB "\\";
+    String end = value + length;
+
+    while (value < end)
+    {
+        size_t span = 0;
+
+        while (value + span < end && !strchr(special, value[span]))
+        {
+            span++;
+        }
+
+        Exception ex = expansion_write(instance, value, span);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        value += span;
+
+        if (value == end)
+        {
+            break;
+        }
+
+        if (quoted || *value == '\\')
+        {
+            ex = expansion_write(instance, "\\", 1);
+            instance->escaped = true;
+        }
+        else
+        {
+            instance->glob = true;
+        }
+
+        if (!ex)
+        {
+            ex = expansion_write(instance, value, 1);
+        }
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        value++;
+    }
+
+    return 0;
+}
+
+static Exception expansion_add(Expansion instance, String value)
+{
+    Arena arena = &instance->state->arena;
+
+    if (instance->count + 1 >= instance->fieldCapacity)
+    {
+        size_t newCapacity = instance->fieldCapacity * 2;
+        String* newFields = arena_allocate(
+            arena,
+            newCapacity * sizeof * newFields);
+
+        if (!newFields)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        memcpy(
+            newFields,
+            instance->fields,
+            instance->count * sizeof * newFields);
+
+        instance->fieldCapacity = newCapacity;
+        instance->fields = newFields;
+    }
+
+    instance->fields[instance->count] = value;
+    instance->count++;
+    instance->fields[instance->count] = NULL;
+
+    return 0;
+}
+
+static Exception expansion_glob_add(
+    Expansion instance,
+    String path,
+    size_t length)
+{
+    String value = arena_copy(&instance->state->arena, path, length);
+
+    if (!value)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    return expansion_add(instance, value);
+}
+
+static Exception expansion_glob_walk(
+    Expansion instance,
+    String path,
+    size_t length,
+    String pattern);
+
+static Exception expansion_glob_descend(
+    Expansion instance,
+    String path,
+    size_t length,
+    String name,
+    String pattern)
+{
+    size_t nameLength = strlen(name);
+
+    if (length + nameLength + 1 >= PATH_MAX)
+    {
+        return 0;
+    }
+
+    memcpy(path + length, name, nameLength);
+
+    length += nameLength;
+    path[length] = '/';
+
+    return expansion_glob_walk(instance, path, length + 1, pattern);
+}
+
+static Exception expansion_glob_walk(
+    Expansion instance,
+    String path,
+    size_t length,
+    String pattern)
+{
+    while (*pattern == '/')
+    {
+        pattern++;
+    }
+
+    struct stat status;
+
+    path[length] = '\0';
+
+    if (!*pattern)
+    {
+        if (stat(path, &status) == 0)
+        {
+            return expansion_glob_add(instance, path, length);
+        }
+
+        return 0;
+    }
+
+    String end = strchr(pattern, '/');
+    bool last = !end;
+
+    if (last)
+    {
+        end = pattern + strlen(pattern);
+    }
+
+    size_t componentLength = end - pattern;
+    char component[componentLength + 1];
+
+    memcpy(component, pattern, componentLength);
+
+    component[componentLength] = '\0';
+
+    if (pattern_is_literal(component))
+    {
+        if (length + componentLength + 1 >= PATH_MAX)
+        {
+            return 0;
+        }
+
+        pattern_unescape(path + length, component);
+
+        length += strlen(path + length);
+
+        if (!last)
+        {
+            path[length] = '/';
+
+            return expansion_glob_walk(instance, path, length + 1, end);
+        }
+
+        if (lstat(path, &status) == 0)
+        {
+            return expansion_glob_add(instance, path, length);
+        }
+
+        return 0;
+    }
+
+    bool recursive = !last && strcmp(component, "**") == 0;
+    Exception ex;
+
+    if (recursive)
+    {
+        ex = expansion_glob_walk(instance, path, length, end);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        path[length] = '\0';
+    }
+
+    Directory directory;
+
+    ex = directory_cache_find(
+        &instance->state->directories,
+        length ? path : ".",
+        &directory);
+
+    if (ex || !directory)
+    {
+        return ex;
+    }
+
+    size_t count = directory->count;
+    DirectoryEntry entries = directory->entries;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        DirectoryEntry entry = entries + i;
+
+        if (recursive)
+        {
+            if (entry->name[0] != '.' &&
+                directory_cache_is_directory(directory, entry, false))
+            {
+                ex = expansion_glob_descend(
+                    instance,
+                    path,
+                    length,
+                    entry->name,
+                    pattern);
+            }
+        }
+        else if ((entry->name[0] != '.' || component[0] == '.') &&
+            pattern_match(component, entry->name))
+        {
+            if (last)
+            {
+                size_t nameLength = strlen(entry->name);
+
+                if (length + nameLength < PATH_MAX)
+                {
+                    memcpy(path + length, entry->name, nameLength);
+
+                    ex = expansion_glob_add(
+                        instance,
+                        path,
+                        length + nameLength);
+                }
+            }
+            else if (directory_cache_is_directory(directory, entry, true))
+            {
+                ex = expansion_glob_descend(
+                    instance,
+                    path,
+                    length,
+                    entry->name,
+                    end);
+            }
+        }
+
+        if (ex)
+        {
+            return ex;
+        }
+    }
+
+    return 0;
+}
+
+static int expansion_compare(const void* left, const void* right)
+{
+    return strcmp(*(String*)left, *(String*)right);
+}
+
+static Exception expansion_glob(Expansion instance)
+{
+    Exception ex = expansion_write(instance, "", 1);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    size_t first = instance->count;
+    char path[PATH_MAX];
+    size_t length = 0;
+
+    if (instance->buffer[0] == '/')
+    {
+        path[0] = '/';
+        length = 1;
+    }
+
+    ex = expansion_glob_walk(instance, path, length, instance->buffer);
+    instance->length--;
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    qsort(
+        instance->fields + first,
+        instance->count - first,
+        sizeof * instance->fields,
+        expansion_compare);
+
+    return 0;
+}
+
+static Exception expansion_emit(Expansion instance)
+{
+    if (!instance->started)
+    {
+        return 0;
+    }
+
+    size_t count = instance->count;
+    bool glob = instance->glob;
+    bool escaped = instance->escaped;
+
+    instance->glob = false;
+    instance->escaped = false;
+
+    if (glob)
+    {
+        Exception ex = expansion_glob(instance);
+
+        if (ex)
+        {
+            return ex;
+        }
+    }
+
+    size_t length = instance->length;
+
+    instance->length = 0;
+    instance->started = false;
+
+    if (instance->count != count)
+    {
+        return 0;
+    }
+
+    String value = arena_copy(
+        &instance->state->arena,
+        instance->buffer,
+        length);
+
+    if (!value)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    if (glob || escaped)
+    {
+        pattern_unescape(value, value);
+    }
+
+    return expansion_add(instance, value);
+}
+
+static Exception expansion_split(Expansion instance, String value)
+{
+    while (*value)
+    {
+        size_t length = strcspn(value, EXPANSION_DELIMITERS);
+
+        if (length)
+        {
+            Exception ex = expansion_append(instance, value, length, false);
+
+            if (ex)
+            {
+                return ex;
+            }
+
+            value += length;
+        }
+
+        if (!*value)
+        {
+            break;
+        }
+
+        Exception ex = expansion_emit(instance);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        value += strspn(value, EXPANSION_DELIMITERS);
+    }
+
+    return 0;
+}
+
+// PIPESTATUS holds the exit status of each stage of the last pipeline. As in
+// bash, $PIPESTATUS is the first stage, ${PIPESTATUS[n]} is stage n, and
+// ${PIPESTATUS[@]} and ${PIPESTATUS[*]} list every stage.
+
+static String expansion_pipe_status(
+    Expansion instance,
+    String name,
+    size_t length)
+{
+    size_t prefix = sizeof EXPANSION_PIPE_STATUS - 1;
+
+    if (length < prefix || memcmp(name, EXPANSION_PIPE_STATUS, prefix) != 0)
+    {
+        return NULL;
+    }
+
+    Parser state = instance->state;
+    String index = name + prefix + 1;
+    size_t indexLength = length - prefix - 2;
+    size_t first = 0;
+    size_t last = 1;
+
+    if (length > prefix)
+    {
+        if (length < prefix + 3 ||
+            index[-1] != '[' ||
+            index[indexLength] != ']')
+        {
+            return NULL;
+        }
+
+        if (indexLength == 1 && (*index == '@' || *index == '*'))
+        {
+            last = state->pipeStatusCount;
+        }
+        else if (strspn(index, "0123456789") >= indexLength &&
+            indexLength < 10)
+        {
+            first = strtoul(index, NULL, 10);
+            last = first + 1;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+
+    if (last > state->pipeStatusCount)
+    {
+        last = state->pipeStatusCount;
+    }
+
+    if (first >= last)
+    {
+        return "";
+    }
+
+    String result = arena_allocate(&state->arena, (last - first) * 12);
+
+    euler_assert(result);
+
+    String p = result;
+
+    for (size_t i = first; i < last; i++)
+    {
+        p += sprintf(p, i == first ? "%d" : " %d", state->pipeStatus[i]);
+    }
+
+    return result;
+}
+
+static String expansion_parameter(Expansion instance, String* value)
+{
+    String p = *value + 1;
+    String name = p;
+    size_t length;
+
+    if (*p == '{')
+    {
+        name++;
+
+        String end = strchr(name, '}');
+
+        if (!end)
+        {
+            return NULL;
+        }
+
+        length = end - name;
+        p = end + 1;
+    }
+    else if (*p == '?' || *p == '$')
+    {
+        length = 1;
+        p++;
+    }
+    else
+    {
+        length = 0;
+
+        while (variable_table_is_name(name, length + 1))
+        {
+            length++;
+        }
+
+        p += length;
+    }
+
+    Parser state = instance->state;
+
+    if (length == 1 && (*name == '?' || *name == '$'))
+    {
+        *value = p;
+
+        snprintf(
+            instance->number,
+            sizeof instance->number,
+            "%d",
+            *name == '?' ? state->status : (int)state->id);
+
+        return instance->number;
+    }
+
+    String pipeStatus = expansion_pipe_status(instance, name, length);
+
+    if (pipeStatus)
+    {
+        *value = p;
+
+        return pipeStatus;
+    }
+
+    if (!variable_table_is_name(name, length))
+    {
+        return NULL;
+    }
+
+    *value = p;
+
+    Variable entry = variable_table_find(&state->variables, name, length);
+
+    if (!entry)
+    {
+        return "";
+    }
+
+    return entry->text + entry->nameLength + 1;
+}
+
+static String expansion_command(Expansion instance, String* value)
+{
+    Substitution item = instance->instruction->substitutions;
+
+    while (item && item->word != *value)
+    {
+        item = item->next;
+    }
+
+    if (!item)
+    {
+        return NULL;
+    }
+
+    *value += item->length;
+
+    String result = execute_handler_capture(
+        instance->state,
+        item->instruction);
+
+    instance->state->substituted = true;
+
+    return result;
+}
+
+static String expansion_substitution(Expansion instance, String* value)
+{
+    if (**value == '$' && (*value)[1] != '(')
+    {
+        return expansion_parameter(instance, value);
+    }
+
+    return expansion_command(instance, value);
+}
+
+static Exception expansion_quoted(Expansion instance, String* value)
+{
+    String p = *value + 1;
+    Exception ex = 0;
+
+    instance->started = true;
+
+    while (!ex && *p != '"')
+    {
+        size_t length = strcspn(p, "\"\\$`");
+
+        if (length)
+        {
+            ex = expansion_append(instance, p, length, true);
+            p += length;
+
+            continue;
+        }
+
+        if (*p == '\\' && strchr("\"\\$`", p[1]))
+        {
+            ex = expansion_append(instance, p + 1, 1, true);
+            p += 2;
+
+            continue;
+        }
+
+        String parameter = NULL;
+
+        if (*p == '$' || *p == '`')
+        {
+            parameter = expansion_substitution(instance, &p);
+        }
+
+        if (parameter)
+        {
+            ex = expansion_append(
+                instance,
+                parameter,
+                strlen(parameter),
+                true);
+        }
+        else
+        {
+            ex = expansion_append(instance, p, 1, true);
+            p++;
+        }
+    }
+
+    *value = p + 1;
+
+    return ex;
+}
+
+static Exception expansion_word(Expansion instance, String value, bool split)
+{
+    Exception ex = 0;
+
+    instance->split = split;
+
+    while (!ex && *value)
+    {
+        size_t length = strcspn(value, EXPANSION_SPECIAL);
+
+        if (length)
+        {
+            ex = expansion_append(instance, value, length, false);
+            value += length;
+
+            continue;
+        }
+
+        switch (*value)
+        {
+        case '\'':
+            length = strchr(value + 1, '\'') - value - 1;
+            ex = expansion_append(instance, value + 1, length, true);
+            value += length + 2;
+            break;
+
+        case '"':
+            ex = expansion_quoted(instance, &value);
+            break;
+
+        case '\\':
+            value++;
+
+            if (!*value)
+            {
+                value--;
+            }
+
+            ex = expansion_append(instance, value, 1, true);
+            value++;
+            break;
+
+        case '*':
+        case '?':
+        case '[':
+            ex = expansion_append(instance, value, 1, false);
+            value++;
+            break;
+
+        default:
+        {
+            String parameter = expansion_substitution(instance, &value);
+
+            if (!parameter)
+            {
+                ex = expansion_append(instance, value, 1, true);
+                value++;
+            }
+            else if (split)
+            {
+                ex = expansion_split(instance, parameter);
+            }
+            else
+            {
+                ex = expansion_write(instance, parameter, strlen(parameter));
+            }
+
+            break;
+        }
+        }
+    }
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    if (!split)
+    {
+        instance->started = true;
+    }
+
+    return expansion_emit(instance);
+}
+
+// Here-document bodies see parameter expansion and a few backslash escapes,
+// but are never split or matched against the file system.
+
+static Exception expansion_document(
+    Expansion instance,
+    String value,
+    String* result)
+{
+    Exception ex = 0;
+
+    instance->split = false;
+
+    while (!ex && *value)
+    {
+        size_t length = strcspn(value, EXPANSION_DOCUMENT);
+
+        if (length)
+        {
+            ex = expansion_write(instance, value, length);
+            value += length;
+
+            continue;
+        }
+
+        if (*value == '\\' && value[1] == '\n')
+        {
+            value += 2;
+
+            continue;
+        }
+
+        if (*value == '\\' && value[1] && strchr("$\\`", value[1]))
+        {
+            ex = expansion_write(instance, value + 1, 1);
+            value += 2;
+
+            continue;
+        }
+
+        String parameter = NULL;
+
+        if (*value == '$' || *value == '`')
+        {
+            parameter = expansion_substitution(instance, &value);
+        }
+
+        if (parameter)
+        {
+            ex = expansion_write(instance, parameter, strlen(parameter));
+        }
+        else
+        {
+            ex = expansion_write(instance, value, 1);
+            value++;
+        }
+    }
+
+    if (!ex)
+    {
+        *result = arena_copy(
+            &instance->state->arena,
+            instance->buffer,
+            instance->length);
+
+        if (!*result)
+        {
+            ex = EXCEPTION_OUT_OF_MEMORY;
+        }
+    }
+
+    instance->length = 0;
+    instance->started = false;
+
+    return ex;
+}
+
+static Exception expansion_substitute(Expansion instance, String word)
+{
+    Substitution item = instance->instruction->substitutions;
+
+    while (item && item->word != word)
+    {
+        item = item->next;
+    }
+
+    if (!item)
+    {
+        return expansion_add(instance, word);
+    }
+
+    int descriptor = execute_handler_substitute(instance->state, item);
+    int length = snprintf(
+        instance->number,
+        sizeof instance->number,
+        EXPANSION_DESCRIPTOR,
+        descriptor);
+    String value = arena_copy(
+        &instance->state->arena,
+        instance->number,
+        length);
+
+    if (!value)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    return expansion_add(instance, value);
+}
+
+static Exception expansion_expand_words(
+    Expansion instance,
+    String words[],
+    size_t count,
+    bool split,
+    String** result,
+    size_t* resultCount)
+{
+    instance->count = 0;
+    instance->fieldCapacity = count + 1;
+    instance->fields = arena_allocate(
+        &instance->state->arena,
+        instance->fieldCapacity * sizeof * instance->fields);
+
+    if (!instance->fields)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->fields[0] = NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        Exception ex;
+
+        if ((words[i][0] == '<' || words[i][0] == '>') && words[i][1] == '(')
+        {
+            ex = expansion_substitute(instance, words[i]);
+        }
+        else if (strpbrk(words[i], EXPANSION_SPECIAL))
+        {
+            ex = expansion_word(instance, words[i], split);
+        }
+        else
+        {
+            ex = expansion_add(instance, words[i]);
+        }
+
+        if (ex)
+        {
+            return ex;
+        }
+    }
+
+    *result = instance->fields;
+
+    if (resultCount)
+    {
+        *resultCount = instance->count;
+    }
+
+    return 0;
+}
+
+Exception expansion_expand(Parser state, Instruction instruction)
+{
+    struct Expansion expansion =
+    {
+        .state = state,
+        .instruction = instruction
+    };
+
+    Exception ex = 0;
+
+    state->substituted = false;
+
+    if (instruction->type == INSTRUCTION_FOR)
+    {
+        ex = expansion_expand_words(
+            &expansion,
+            instruction->words,
+            instruction->wordCount,
+            true,
+            &instruction->arguments,
+            &instruction->length);
+    }
+    else if (instruction->type == INSTRUCTION_COMMAND)
+    {
+        ex = expansion_expand_words(
+            &expansion,
+            instruction->words,
+            instruction->wordCount,
+            true,
+            &instruction->arguments,
+            &instruction->length);
+
+        if (!ex)
+        {
+            ex = expansion_expand_words(
+                &expansion,
+                instruction->assignments,
+                instruction->assignmentCount,
+                false,
+                &instruction->variables,
+                NULL);
+        }
+    }
+
+    for (Redirection p = instruction->redirections; !ex && p; p = p->next)
+    {
+        if (!p->word)
+        {
+            continue;
+        }
+
+        if (p->type == REDIRECTION_DOCUMENT)
+        {
+            p->target = p->word;
+
+            if (strpbrk(p->word, EXPANSION_DOCUMENT))
+            {
+                ex = expansion_document(&expansion, p->word, &p->target);
+            }
+
+            continue;
+        }
+
+        String* target;
+
+        ex = expansion_expand_words(
+            &expansion,
+            &p->word,
+            1,
+            false,
+            &target,
+            NULL);
+
+        if (ex)
+        {
+            break;
+        }
+
+        p->target = target[0];
+
+        if (p->type == REDIRECTION_STRING)
+        {
+            size_t length = strlen(p->target);
+            String value = arena_allocate(&state->arena, length + 2);
+
+            if (!value)
+            {
+                ex = EXCEPTION_OUT_OF_MEMORY;
+
+                break;
+            }
+
+            memcpy(value, p->target, length);
+
+            value[length] = '\n';
+            value[length + 1] = '\0';
+            p->target = value;
+        }
+    }
+
+    free(expansion.buffer);
+
+    return ex;
+}
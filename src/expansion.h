@@ -0,0 +1,16 @@
+// expansion.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+
+#ifndef EXPANSION_5e2b7c1d9f4a4e0c8b6d3a1f2e9c7b4d
+#define EXPANSION_5e2b7c1d9f4a4e0c8b6d3a1f2e9c7b4d
+#include "euler.h"
+#include "job_collection.h"
+#include "parser.h"
+
+Exception expansion_expand(Parser state, Instruction instruction);
+
+#endif
@@ -0,0 +1,85 @@
+// export_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/export.html
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "handler.h"
+#include "stream.h"
+
+static int export_handler_print(VariableTable variables, int output)
+{
+    char* buffer;
+    size_t length;
+    FILE* stream = open_memstream(&buffer, &length);
+
+    euler_assert(stream);
+
+    for (size_t i = 0; i < variables->exportCount; i++)
+    {
+        fprintf(stream, "export %s\n", variables->environment[i]);
+    }
+
+    euler_assert(fclose(stream) == 0);
+
+    bool result = stream_write(output, buffer, length);
+
+    free(buffer);
+
+    return !result;
+}
+
+int export_handler(
+    Parser state,
+    Instruction instruction,
+    EULER_UNUSED int input,
+    int output)
+{
+    VariableTable variables = &state->variables;
+
+    if (instruction->length == 1)
+    {
+        return export_handler_print(variables, output);
+    }
+
+    int result = 0;
+
+    for (size_t i = 1; i < instruction->length; i++)
+    {
+        String argument = instruction->arguments[i];
+        String separator = strchr(argument, '=');
+        size_t length = strlen(argument);
+
+        if (separator)
+        {
+            length = separator - argument;
+        }
+
+        if (!variable_table_is_name(argument, length))
+        {
+            fprintf(stderr, "Error: invalid variable\n");
+
+            result = 1;
+
+            continue;
+        }
+
+        if (separator)
+        {
+            euler_ok(variable_table_set(
+                variables,
+                argument,
+                length,
+                separator + 1));
+        }
+
+        euler_ok(variable_table_export(variables, argument, length));
+    }
+
+    return result;
+}
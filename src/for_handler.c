@@ -0,0 +1,62 @@
+// for_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+
+#include <signal.h>
+#include <string.h>
+#include "handler.h"
+
+bool for_handler(Parser state, Instruction instruction)
+{
+    size_t length = strlen(instruction->name);
+    bool result = true;
+    int status = 0;
+    struct ArenaMark mark = arena_mark(&state->arena);
+    struct sigaction previous;
+    bool installed = while_handler_begin(&previous);
+
+    for (size_t i = 0; i < instruction->length; i++)
+    {
+        euler_ok(variable_table_set(
+            &state->variables,
+            instruction->name,
+            length,
+            instruction->arguments[i]));
+
+        if (!parser_execute(state, instruction->right))
+        {
+            result = false;
+
+            break;
+        }
+
+        status = state->status;
+
+        arena_rewind(&state->arena, mark);
+        directory_cache_clear(&state->directories);
+
+        if (job_collection_changed())
+        {
+            job_collection_reap(&state->jobs);
+        }
+
+        if (while_handler_interrupted(state))
+        {
+            status = state->status;
+
+            break;
+        }
+    }
+
+    while_handler_end(installed, &previous);
+
+    if (result)
+    {
+        state->status = status;
+    }
+
+    return result;
+}
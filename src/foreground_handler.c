@@ -3,43 +3,44 @@
 // Licensed under the MIT license.
 
 // References:
-//  - https://www.man7.org/linux/man-pages/man2/kill.2.html
-//  - https://www.man7.org/linux/man-pages/man3/strtol.3.html
+//  - https://www.man7.org/linux/man-pages/man3/killpg.3.html
 //  - https://www.gnu.org/software/libc/manual/html_node/Continuing-Stopped-Jobs.html
 //  - https://www.gnu.org/software/libc/manual/html_node/Foreground-and-Background.html
 //  - https://web.stanford.edu/class/cs110/summer-2021/lecture-notes/lecture-08
 
-#include <sys/wait.h>
 #include <signal.h>
 #include "handler.h"
 
-bool foreground_handler(JobCollection jobs, Instruction instruction)
+bool foreground_handler(Parser state, Instruction instruction)
 {
-    unsigned long long job = strtoull(instruction->payload.argument, NULL, 10);
+    JobCollection jobs = &state->jobs;
+    size_t id = job_collection_find(jobs, instruction->arguments[1]);
+    Job item = job_collection_get(jobs, id);
 
-    if (job < 1 || job > jobs->count)
+    if (!item)
     {
         fprintf(stderr, "Error: invalid job\n");
 
+        state->status = 1;
+
         return true;
     }
-    
-    struct Job item = jobs->items[job - 1];
-    
-    euler_ok(job_collection_remove_at(jobs, job - 1));
-    kill(item.pid, SIGCONT);
-    
-    int status;
-    
-    euler_assert(waitpid(item.pid, &status, WUNTRACED) != -1);
-    
-    if (WIFSTOPPED(status))
+
+    if (parallel_handler_resume(state, id))
     {
-        euler_ok(job_collection_add(jobs, item.pid, item.first));
+        return true;
     }
-    else
+
+    killpg(item->group, SIGCONT);
+
+    item->state = JOB_STATE_RUNNING;
+
+    job_collection_wait(jobs, item);
+    euler_ok(parser_set_status(state, item));
+
+    if (item->state != JOB_STATE_STOPPED)
     {
-        job_collection_free_instruction(jobs, item.first);
+        euler_ok(job_collection_remove(jobs, id));
     }
 
     return true;
@@ -2,14 +2,118 @@
 // Copyright (c) 2024 Ishan Pranav
 // Licensed under the MIT license.
 
+#include <signal.h>
 #include <stdbool.h>
 #include "argument_vector.h"
 #include "job_collection.h"
+#include "parser.h"
+#define EXECUTE_HANDLER_DESCRIPTORS 10
 
-typedef bool (*Handler)(JobCollection jobs, Instruction instruction);
+typedef bool (*Handler)(Parser state, Instruction instruction);
 
-bool exit_handler(JobCollection jobs, Instruction instruction);
-bool change_directory_handler(JobCollection jobs, Instruction instruction);
-bool foreground_handler(JobCollection jobs, Instruction instruction);
-bool jobs_handler(JobCollection jobs, Instruction instruction);
-bool execute_handler(JobCollection jobs, Instruction instruction);
+typedef int (*BuiltinHandler)(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
+
+typedef bool (*BuiltinPredicate)(Instruction instruction);
+
+// A builtin that declines an instruction through its predicate leaves the
+// command to the program on the search path, which supports every option.
+
+struct Builtin
+{
+    String name;
+    BuiltinHandler execute;
+    BuiltinPredicate accepts;
+    bool input;
+};
+
+typedef const struct Builtin* Builtin;
+
+bool exit_handler(Parser state, Instruction instruction);
+bool change_directory_handler(Parser state, Instruction instruction);
+bool foreground_handler(Parser state, Instruction instruction);
+bool background_handler(Parser state, Instruction instruction);
+bool jobs_handler(Parser state, Instruction instruction);
+bool hash_handler(Parser state, Instruction instruction);
+bool assignment_handler(Parser state, Instruction instruction);
+bool execute_handler(Parser state, Instruction instruction);
+bool sequence_handler(Parser state, Instruction instruction);
+bool and_handler(Parser state, Instruction instruction);
+bool or_handler(Parser state, Instruction instruction);
+bool time_handler(Parser state, Instruction instruction);
+bool if_handler(Parser state, Instruction instruction);
+bool while_handler(Parser state, Instruction instruction);
+bool while_handler_begin(struct sigaction* previous);
+bool while_handler_interrupted(Parser state);
+void while_handler_end(bool installed, const struct sigaction* previous);
+bool for_handler(Parser state, Instruction instruction);
+
+pid_t execute_handler_run(
+    Parser state,
+    Instruction current,
+    int descriptors[],
+    pid_t group,
+    int sibling);
+
+int execute_handler_substitute(Parser state, Substitution value);
+String execute_handler_capture(Parser state, Instruction instruction);
+Builtin builtin_handler_find(Instruction instruction);
+int echo_handler(Parser state, Instruction instruction, int input, int output);
+
+bool printf_handler_accepts(Instruction instruction);
+bool concatenate_handler_accepts(Instruction instruction);
+bool print_working_directory_handler_accepts(Instruction instruction);
+
+int printf_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
+
+int parallel_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
+
+bool parallel_handler_owns(Parser state, size_t id);
+bool parallel_handler_resume(Parser state, size_t id);
+void finalize_parallel_handler(Parser state);
+
+int history_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
+
+int true_handler(Parser state, Instruction instruction, int input, int output);
+int false_handler(Parser state, Instruction instruction, int input, int output);
+
+int print_working_directory_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
+
+int test_handler(Parser state, Instruction instruction, int input, int output);
+
+int export_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
+
+int unset_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
+
+int concatenate_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output);
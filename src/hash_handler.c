@@ -0,0 +1,75 @@
+// hash_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.gnu.org/software/bash/manual/html_node/Bourne-Shell-Builtins.html
+
+#include <string.h>
+#include "handler.h"
+
+bool hash_handler(Parser state, Instruction instruction)
+{
+    CommandTable commands = &state->commands;
+
+    state->status = 0;
+
+    if (instruction->length == 1)
+    {
+        if (!commands->count)
+        {
+            return true;
+        }
+
+        printf("hits\tcommand\n");
+
+        for (size_t i = 0; i < commands->capacity; i++)
+        {
+            for (CommandEntry entry = commands->buckets[i];
+                entry;
+                entry = entry->next)
+            {
+                printf("%4zu\t%s\n", entry->hits, entry->path);
+            }
+        }
+
+        return true;
+    }
+
+    for (size_t i = 1; i < instruction->length; i++)
+    {
+        String name = instruction->arguments[i];
+
+        if (strcmp(name, "-r") == 0)
+        {
+            command_table_clear(commands);
+
+            continue;
+        }
+
+        if (strcmp(name, "-s") == 0)
+        {
+            printf(
+                "parse cache: %zu hits, %zu misses, %zu lines\n",
+                state->cache.hits,
+                state->cache.misses,
+                state->cache.count);
+
+            continue;
+        }
+
+        String path;
+
+        command_table_remove(commands, name);
+        euler_ok(command_table_find(commands, name, &path));
+
+        if (!path)
+        {
+            fprintf(stderr, "Error: invalid program\n");
+
+            state->status = 1;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,765 @@
+// history.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/mmap.2.html
+//  - https://www.man7.org/linux/man-pages/man2/writev.2.html
+//  - https://swtch.com/~rsc/regexp/regexp4.html
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "history.h"
+#define HISTORY_POSTING_CAPACITY 1024
+
+void history(History instance, size_t capacity)
+{
+    if (capacity < 16)
+    {
+        capacity = 16;
+    }
+
+    instance->descriptor = -1;
+    instance->map = NULL;
+    instance->mapLength = 0;
+    instance->lineCount = 0;
+    instance->lines = NULL;
+    instance->count = 0;
+    instance->capacity = capacity;
+    instance->items = NULL;
+    instance->indexed = 0;
+    instance->postingCount = 0;
+    instance->postingCapacity = 0;
+    instance->postings = NULL;
+}
+
+Exception history_load(History instance, String path)
+{
+    int descriptor = open(path, O_CLOEXEC | O_RDONLY);
+
+    if (descriptor != -1)
+    {
+        struct stat status;
+
+        if (fstat(descriptor, &status) == 0 &&
+            S_ISREG(status.st_mode) &&
+            status.st_size)
+        {
+            void* map = mmap(
+                NULL,
+                status.st_size,
+                PROT_READ,
+                MAP_PRIVATE,
+                descriptor,
+                0);
+
+            if (map != MAP_FAILED)
+            {
+                instance->map = map;
+                instance->mapLength = status.st_size;
+            }
+        }
+
+        close(descriptor);
+    }
+
+    instance->descriptor = open(
+        path,
+        O_APPEND | O_CLOEXEC | O_CREAT | O_WRONLY,
+        S_IRUSR | S_IWUSR);
+
+    return 0;
+}
+
+static Exception history_index_lines(History instance)
+{
+    if (instance->lines || !instance->map)
+    {
+        return 0;
+    }
+
+    String end = instance->map + instance->mapLength;
+    size_t count = 0;
+
+    for (String p = instance->map; p < end; count++)
+    {
+        String next = memchr(p, '\n', end - p);
+
+        if (!next)
+        {
+            break;
+        }
+
+        p = next + 1;
+    }
+
+    if (end[-1] != '\n')
+    {
+        count++;
+    }
+
+    instance->lines = malloc((count + 1) * sizeof * instance->lines);
+
+    if (!instance->lines)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    String p = instance->map;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        instance->lines[i] = p - instance->map;
+
+        String next = memchr(p, '\n', end - p);
+
+        p = next ? next + 1 : end + 1;
+    }
+
+    instance->lines[count] = p - instance->map;
+    instance->lineCount = count;
+
+    return 0;
+}
+
+Exception history_count(History instance, size_t* result)
+{
+    Exception ex = history_index_lines(instance);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    *result = instance->lineCount + instance->count;
+
+    return 0;
+}
+
+bool history_get(
+    History instance,
+    size_t number,
+    String* result,
+    size_t* length)
+{
+    if (!number || history_index_lines(instance))
+    {
+        return false;
+    }
+
+    if (number <= instance->lineCount)
+    {
+        size_t offset = instance->lines[number - 1];
+
+        *result = instance->map + offset;
+        *length = instance->lines[number] - offset - 1;
+
+        return true;
+    }
+
+    size_t index = number - instance->lineCount - 1;
+
+    if (index >= instance->count ||
+        instance->count - index > instance->capacity)
+    {
+        return false;
+    }
+
+    *result = instance->items[index % instance->capacity];
+    *length = strlen(*result);
+
+    return true;
+}
+
+static bool history_last(History instance, String* result, size_t* length)
+{
+    if (instance->count)
+    {
+        *result = instance->items[(instance->count - 1) % instance->capacity];
+        *length = strlen(*result);
+
+        return true;
+    }
+
+    if (!instance->map)
+    {
+        return false;
+    }
+
+    String end = instance->map + instance->mapLength;
+
+    if (end[-1] == '\n')
+    {
+        end--;
+    }
+
+    String start = end;
+
+    while (start > instance->map && start[-1] != '\n')
+    {
+        start--;
+    }
+
+    *result = start;
+    *length = end - start;
+
+    return true;
+}
+
+Exception history_add(History instance, String value, size_t length)
+{
+    if (!length)
+    {
+        return 0;
+    }
+
+    if (!instance->items)
+    {
+        instance->items = calloc(instance->capacity, sizeof * instance->items);
+
+        if (!instance->items)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+    }
+
+    String item = malloc(length + 1);
+
+    if (!item)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    memcpy(item, value, length);
+
+    item[length] = '\0';
+
+    size_t index = instance->count % instance->capacity;
+
+    free(instance->items[index]);
+
+    instance->items[index] = item;
+    instance->count++;
+
+    if (instance->descriptor != -1)
+    {
+        struct iovec vectors[2] =
+        {
+            { .iov_base = item, .iov_len = length },
+            { .iov_base = "\n", .iov_len = 1 }
+        };
+
+        if (writev(instance->descriptor, vectors, 2) == -1)
+        {
+            close(instance->descriptor);
+
+            instance->descriptor = -1;
+        }
+    }
+
+    return 0;
+}
+
+static Exception history_event(
+    History instance,
+    String value,
+    String end,
+    size_t* consumed,
+    String* result,
+    size_t* length)
+{
+    *result = NULL;
+    *consumed = 1;
+
+    if (value + 1 < end && value[1] == '!')
+    {
+        *consumed = 2;
+
+        history_last(instance, result, length);
+
+        return 0;
+    }
+
+    String p = value + 1;
+    bool relative = p < end && *p == '-';
+
+    if (relative)
+    {
+        p++;
+    }
+
+    if (p == end || !isdigit((unsigned char)*p))
+    {
+        *result = value;
+        *length = 1;
+
+        return 0;
+    }
+
+    size_t number = 0;
+
+    while (p < end && isdigit((unsigned char)*p))
+    {
+        number = number * 10 + (*p - '0');
+        p++;
+    }
+
+    *consumed = p - value;
+
+    if (relative)
+    {
+        size_t count;
+        Exception ex = history_count(instance, &count);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        if (!number || number > count)
+        {
+            return 0;
+        }
+
+        number = count - number + 1;
+    }
+
+    history_get(instance, number, result, length);
+
+    return 0;
+}
+
+// As in bash, an event designator inside single quotes or after a backslash
+// is left alone. Double quotes do not protect it. The quote state carries
+// over between calls on the same line.
+
+static String history_find_event(String value, String end, char* quote)
+{
+    for (String p = value; p < end; p++)
+    {
+        if (*quote == '\'')
+        {
+            if (*p == '\'')
+            {
+                *quote = '\0';
+            }
+
+            continue;
+        }
+
+        switch (*p)
+        {
+        case '\\':
+            if (p + 1 < end)
+            {
+                p++;
+            }
+            break;
+
+        case '\'':
+            if (!*quote)
+            {
+                *quote = '\'';
+            }
+            break;
+
+        case '"':
+            *quote = *quote ? '\0' : '"';
+            break;
+
+        case '!':
+            return p;
+        }
+    }
+
+    return end;
+}
+
+Exception history_expand(
+    History instance,
+    Arena arena,
+    String value,
+    size_t length,
+    String* result,
+    size_t* resultLength)
+{
+    String end = value + length;
+    size_t total = 0;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        String output = NULL;
+        char quote = '\0';
+
+        if (pass)
+        {
+            output = *result;
+        }
+
+        for (String p = value; p < end;)
+        {
+            String next = history_find_event(p, end, &quote);
+
+            if (pass)
+            {
+                memcpy(output, p, next - p);
+
+                output += next - p;
+            }
+            else
+            {
+                total += next - p;
+            }
+
+            if (next == end)
+            {
+                break;
+            }
+
+            String text;
+            size_t textLength;
+            size_t consumed;
+            Exception ex = history_event(
+                instance,
+                next,
+                end,
+                &consumed,
+                &text,
+                &textLength);
+
+            if (ex)
+            {
+                return ex;
+            }
+
+            if (!text)
+            {
+                *result = NULL;
+
+                return 0;
+            }
+
+            if (pass)
+            {
+                memcpy(output, text, textLength);
+
+                output += textLength;
+            }
+            else
+            {
+                total += textLength;
+            }
+
+            p = next + consumed;
+        }
+
+        if (!pass)
+        {
+            *result = arena_allocate(arena, total + 1);
+
+            if (!*result)
+            {
+                return EXCEPTION_OUT_OF_MEMORY;
+            }
+        }
+        else
+        {
+            *output = '\0';
+        }
+    }
+
+    *resultLength = total;
+
+    return 0;
+}
+
+static size_t history_hash(
+    HistoryPosting postings,
+    size_t capacity,
+    uint32_t key)
+{
+    size_t i = (key * 2654435761u) & (capacity - 1);
+
+    while (postings[i].key && postings[i].key != key)
+    {
+        i = (i + 1) & (capacity - 1);
+    }
+
+    return i;
+}
+
+static Exception history_ensure_postings(History instance)
+{
+    if ((instance->postingCount + 1) * 2 <= instance->postingCapacity)
+    {
+        return 0;
+    }
+
+    size_t newCapacity = instance->postingCapacity * 2;
+
+    if (!newCapacity)
+    {
+        newCapacity = HISTORY_POSTING_CAPACITY;
+    }
+
+    HistoryPosting newPostings = calloc(newCapacity, sizeof * newPostings);
+
+    if (!newPostings)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < instance->postingCapacity; i++)
+    {
+        HistoryPosting posting = instance->postings + i;
+
+        if (posting->key)
+        {
+            newPostings[history_hash(newPostings, newCapacity, posting->key)] =
+                *posting;
+        }
+    }
+
+    free(instance->postings);
+
+    instance->postings = newPostings;
+    instance->postingCapacity = newCapacity;
+
+    return 0;
+}
+
+static uint32_t history_trigram(String value)
+{
+    unsigned char* p = (unsigned char*)value;
+
+    return 0x1000000u | (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+}
+
+static Exception history_index(History instance, size_t count)
+{
+    for (size_t number = instance->indexed + 1; number <= count; number++)
+    {
+        String text;
+        size_t length;
+
+        if (!history_get(instance, number, &text, &length))
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i + 3 <= length; i++)
+        {
+            Exception ex = history_ensure_postings(instance);
+
+            if (ex)
+            {
+                return ex;
+            }
+
+            uint32_t key = history_trigram(text + i);
+            HistoryPosting posting = instance->postings + history_hash(
+                instance->postings,
+                instance->postingCapacity,
+                key);
+
+            if (!posting->key)
+            {
+                posting->key = key;
+                instance->postingCount++;
+            }
+
+            if (posting->count && posting->items[posting->count - 1] == number)
+            {
+                continue;
+            }
+
+            if (posting->count == posting->capacity)
+            {
+                size_t newCapacity = posting->capacity * 2;
+
+                if (!newCapacity)
+                {
+                    newCapacity = 4;
+                }
+
+                uint32_t* newItems = realloc(
+                    posting->items,
+                    newCapacity * sizeof * newItems);
+
+                if (!newItems)
+                {
+                    return EXCEPTION_OUT_OF_MEMORY;
+                }
+
+                posting->capacity = newCapacity;
+                posting->items = newItems;
+            }
+
+            posting->items[posting->count] = number;
+            posting->count++;
+        }
+    }
+
+    instance->indexed = count;
+
+    return 0;
+}
+
+static bool history_contains(
+    String value,
+    size_t length,
+    String query,
+    size_t queryLength)
+{
+    while (length >= queryLength)
+    {
+        String match = memchr(value, query[0], length - queryLength + 1);
+
+        if (!match)
+        {
+            return false;
+        }
+
+        if (memcmp(match, query, queryLength) == 0)
+        {
+            return true;
+        }
+
+        length -= match - value + 1;
+        value = match + 1;
+    }
+
+    return false;
+}
+
+Exception history_search(
+    History instance,
+    String query,
+    size_t before,
+    size_t* result)
+{
+    size_t count;
+    Exception ex = history_count(instance, &count);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    if (!before || before > count + 1)
+    {
+        before = count + 1;
+    }
+
+    size_t queryLength = strlen(query);
+    String text;
+    size_t length;
+
+    *result = 0;
+
+    if (!queryLength)
+    {
+        return 0;
+    }
+
+    if (queryLength < 3)
+    {
+        for (size_t number = before - 1; number; number--)
+        {
+            if (history_get(instance, number, &text, &length) &&
+                history_contains(text, length, query, queryLength))
+            {
+                *result = number;
+
+                return 0;
+            }
+        }
+
+        return 0;
+    }
+
+    ex = history_index(instance, count);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    HistoryPosting rarest = NULL;
+
+    for (size_t i = 0; i + 3 <= queryLength; i++)
+    {
+        if (!instance->postingCapacity)
+        {
+            return 0;
+        }
+
+        HistoryPosting posting = instance->postings + history_hash(
+            instance->postings,
+            instance->postingCapacity,
+            history_trigram(query + i));
+
+        if (!posting->key)
+        {
+            return 0;
+        }
+
+        if (!rarest || posting->count < rarest->count)
+        {
+            rarest = posting;
+        }
+    }
+
+    for (size_t i = rarest->count; i; i--)
+    {
+        size_t number = rarest->items[i - 1];
+
+        if (number < before &&
+            history_get(instance, number, &text, &length) &&
+            history_contains(text, length, query, queryLength))
+        {
+            *result = number;
+
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+void finalize_history(History instance)
+{
+    if (instance->descriptor != -1)
+    {
+        close(instance->descriptor);
+    }
+
+    if (instance->map)
+    {
+        munmap(instance->map, instance->mapLength);
+    }
+
+    if (instance->items)
+    {
+        for (size_t i = 0; i < instance->capacity; i++)
+        {
+            free(instance->items[i]);
+        }
+    }
+
+    for (size_t i = 0; i < instance->postingCapacity; i++)
+    {
+        free(instance->postings[i].items);
+    }
+
+    free(instance->lines);
+    free(instance->items);
+    free(instance->postings);
+    history(instance, instance->capacity);
+}
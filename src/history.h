@@ -0,0 +1,72 @@
+// history.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.gnu.org/software/bash/manual/html_node/History-Interaction.html
+//  - https://en.wikipedia.org/wiki/Trigram_search
+
+#ifndef HISTORY_5f0a6a0e3c1e4b7d9d2a8c61e4b3f7a2
+#define HISTORY_5f0a6a0e3c1e4b7d9d2a8c61e4b3f7a2
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+#include "euler.h"
+
+struct HistoryPosting
+{
+    uint32_t key;
+    size_t count;
+    size_t capacity;
+    uint32_t* items;
+};
+
+struct History
+{
+    int descriptor;
+    char* map;
+    size_t mapLength;
+    size_t lineCount;
+    size_t* lines;
+    size_t count;
+    size_t capacity;
+    char** items;
+    size_t indexed;
+    size_t postingCount;
+    size_t postingCapacity;
+    struct HistoryPosting* postings;
+};
+
+typedef struct HistoryPosting* HistoryPosting;
+typedef struct History* History;
+
+void history(History instance, size_t capacity);
+Exception history_load(History instance, String path);
+Exception history_count(History instance, size_t* result);
+
+bool history_get(
+    History instance,
+    size_t number,
+    String* result,
+    size_t* length);
+
+Exception history_add(History instance, String value, size_t length);
+
+Exception history_expand(
+    History instance,
+    Arena arena,
+    String value,
+    size_t length,
+    String* result,
+    size_t* resultLength);
+
+Exception history_search(
+    History instance,
+    String query,
+    size_t before,
+    size_t* result);
+
+void finalize_history(History instance);
+
+#endif
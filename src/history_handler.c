@@ -0,0 +1,71 @@
+// history_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.gnu.org/software/bash/manual/html_node/Bash-History-Builtins.html
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "handler.h"
+#include "stream.h"
+
+int history_handler(
+    Parser state,
+    Instruction instruction,
+    EULER_UNUSED int input,
+    int output)
+{
+    History history = &state->history;
+    size_t count;
+
+    euler_ok(history_count(history, &count));
+
+    size_t first = 1;
+
+    if (instruction->length > 1)
+    {
+        char* end;
+        unsigned long long last = strtoull(
+            instruction->arguments[1],
+            &end,
+            10);
+
+        if (*end || instruction->length > 2)
+        {
+            fprintf(stderr, "Error: invalid command\n");
+
+            return 2;
+        }
+
+        if (last < count)
+        {
+            first = count - last + 1;
+        }
+    }
+
+    char* buffer;
+    size_t length;
+    FILE* stream = open_memstream(&buffer, &length);
+
+    euler_assert(stream);
+
+    for (size_t number = first; number <= count; number++)
+    {
+        String text;
+        size_t textLength;
+
+        if (history_get(history, number, &text, &textLength))
+        {
+            fprintf(stream, "%5zu  %.*s\n", number, (int)textLength, text);
+        }
+    }
+
+    euler_assert(fclose(stream) == 0);
+
+    bool result = stream_write(output, buffer, length);
+
+    free(buffer);
+
+    return !result;
+}
@@ -2,14 +2,188 @@
 // Copyright (c) 2024 Ishan Pranav
 // Licensed under the MIT license.
 
-// https://github.com/ishanpranav/codebook/blob/master/lib/list.c
-
+// References:
+//  - https://github.com/ishanpranav/codebook/blob/master/lib/list.c
+//  - https://en.wikipedia.org/wiki/Linear_probing
+//  - https://www.gnu.org/software/bash/manual/html_node/Job-Control-Basics.html
+//  - https://www.man7.org/linux/man-pages/man2/setpgid.2.html
+//  - https://www.man7.org/linux/man-pages/man3/tcsetpgrp.3.html
+//  - https://www.man7.org/linux/man-pages/man2/wait.2.html
+//  - https://www.man7.org/linux/man-pages/man2/wait4.2.html
+//  - https://www.gnu.org/software/libc/manual/html_node/Implementing-a-Shell.html
+
+#define _DEFAULT_SOURCE
 #include <sys/wait.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "euler.h"
 #include "job_collection.h"
+#include "trace.h"
+#define JOB_COLLECTION_INDEX_CAPACITY 16
+
+static volatile sig_atomic_t jobCollectionChanged;
+
+void job(
+    Job instance,
+    String text,
+    pid_t pids[],
+    int statuses[],
+    struct rusage usages[],
+    size_t count)
+{
+    instance->group = 0;
+    instance->count = count;
+    instance->running = 0;
+    instance->pids = pids;
+    instance->statuses = statuses;
+    instance->usages = usages;
+    instance->state = JOB_STATE_RUNNING;
+    instance->text = text;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        usages[i] = (struct rusage) { 0 };
+
+        if (pids[i] == -1)
+        {
+            statuses[i] = JOB_STATUS_NOT_FOUND;
+
+            continue;
+        }
+
+        if (!pids[i])
+        {
+            continue;
+        }
+
+        if (!instance->group)
+        {
+            instance->group = pids[i];
+        }
+
+        statuses[i] = -1;
+        instance->running++;
+    }
+
+    if (!instance->running)
+    {
+        instance->state = JOB_STATE_DONE;
+    }
+
+    arena(&instance->arena, 0);
+}
+
+int job_status_code(int status)
+{
+    if (status == -1)
+    {
+        return 128 + SIGTSTP;
+    }
+
+    if (WIFSIGNALED(status))
+    {
+        return 128 + WTERMSIG(status);
+    }
+
+    if (WIFSTOPPED(status))
+    {
+        return 128 + WSTOPSIG(status);
+    }
+
+    return WEXITSTATUS(status);
+}
+
+static void job_update_at(
+    Job instance,
+    size_t member,
+    int status,
+    const struct rusage* usage)
+{
+    if (WIFSTOPPED(status))
+    {
+        instance->state = JOB_STATE_STOPPED;
+        instance->usages[member] = *usage;
+    }
+    else if (WIFCONTINUED(status))
+    {
+        instance->state = JOB_STATE_RUNNING;
+    }
+    else if (instance->statuses[member] == -1)
+    {
+        instance->statuses[member] = status;
+        instance->usages[member] = *usage;
+        instance->running--;
+
+        if (!instance->running)
+        {
+            instance->state = JOB_STATE_DONE;
+        }
+    }
+}
+
+bool job_update(
+    Job instance,
+    pid_t pid,
+    int status,
+    const struct rusage* usage)
+{
+    for (size_t i = 0; i < instance->count; i++)
+    {
+        if (instance->pids[i] == pid)
+        {
+            job_update_at(instance, i, status, usage);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void job_add_time(struct timeval* result, struct timeval value)
+{
+    result->tv_sec += value.tv_sec;
+    result->tv_usec += value.tv_usec;
+
+    if (result->tv_usec >= 1000000)
+    {
+        result->tv_sec++;
+        result->tv_usec -= 1000000;
+    }
+}
+
+void job_usage(Job instance, struct rusage* result)
+{
+    *result = (struct rusage) { 0 };
+
+    for (size_t i = 0; i < instance->count; i++)
+    {
+        struct rusage* usage = instance->usages + i;
+
+        job_add_time(&result->ru_utime, usage->ru_utime);
+        job_add_time(&result->ru_stime, usage->ru_stime);
+
+        if (usage->ru_maxrss > result->ru_maxrss)
+        {
+            result->ru_maxrss = usage->ru_maxrss;
+        }
+
+        result->ru_minflt += usage->ru_minflt;
+        result->ru_majflt += usage->ru_majflt;
+        result->ru_nvcsw += usage->ru_nvcsw;
+        result->ru_nivcsw += usage->ru_nivcsw;
+    }
+}
+
+void finalize_job(Job instance)
+{
+    finalize_arena(&instance->arena);
+}
 
 Exception job_collection(JobCollection instance, size_t capacity)
 {
@@ -25,14 +199,55 @@ Exception job_collection(JobCollection instance, size_t capacity)
         return EXCEPTION_OUT_OF_MEMORY;
     }
 
+    instance->vacancies = malloc(capacity * sizeof * instance->vacancies);
+
+    if (!instance->vacancies)
+    {
+        free(instance->items);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->index = calloc(
+        JOB_COLLECTION_INDEX_CAPACITY,
+        sizeof * instance->index);
+
+    if (!instance->index)
+    {
+        free(instance->items);
+        free(instance->vacancies);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->terminal = -1;
+    instance->subshell = false;
+    instance->group = getpgrp();
     instance->count = 0;
+    instance->end = 0;
     instance->capacity = capacity;
-    instance->freeList = NULL;
-    instance->aliasReference = NULL;
+    instance->vacancyCount = 0;
+    instance->indexCount = 0;
+    instance->indexCapacity = JOB_COLLECTION_INDEX_CAPACITY;
 
     return 0;
 }
 
+void job_collection_control_terminal(JobCollection instance, int terminal)
+{
+    setpgid(0, 0);
+
+    instance->group = getpgrp();
+
+    if (tcsetpgrp(terminal, instance->group) == -1 ||
+        tcgetattr(terminal, &instance->modes) == -1)
+    {
+        return;
+    }
+
+    instance->terminal = terminal;
+}
+
 Exception job_collection_ensure_capacity(
     JobCollection instance,
     size_t capacity)
@@ -58,102 +273,546 @@ Exception job_collection_ensure_capacity(
         return EXCEPTION_OUT_OF_MEMORY;
     }
 
-    instance->capacity = newCapacity;
     instance->items = newItems;
 
+    size_t* newVacancies = realloc(
+        instance->vacancies,
+        newCapacity * sizeof * newVacancies);
+
+    if (!newVacancies)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->capacity = newCapacity;
+    instance->vacancies = newVacancies;
+
     return 0;
 }
 
+static size_t job_collection_hash(JobCollection instance, pid_t pid)
+{
+    return ((size_t)pid * 11400714819323198485ull) &
+        (instance->indexCapacity - 1);
+}
+
+static void job_collection_index_insert(
+    JobCollection instance,
+    pid_t pid,
+    size_t slot,
+    size_t member)
+{
+    size_t i = job_collection_hash(instance, pid);
+
+    while (instance->index[i].pid)
+    {
+        i = (i + 1) & (instance->indexCapacity - 1);
+    }
+
+    instance->index[i].pid = pid;
+    instance->index[i].slot = slot;
+    instance->index[i].member = member;
+    instance->indexCount++;
+}
+
+static Exception job_collection_index_ensure_capacity(
+    JobCollection instance,
+    size_t count)
+{
+    if (count * 2 <= instance->indexCapacity)
+    {
+        return 0;
+    }
+
+    size_t oldCapacity = instance->indexCapacity;
+    JobIndexEntry oldIndex = instance->index;
+    size_t newCapacity = oldCapacity * 2;
+
+    while (count * 2 > newCapacity)
+    {
+        newCapacity *= 2;
+    }
+
+    JobIndexEntry newIndex = calloc(newCapacity, sizeof * newIndex);
+
+    if (!newIndex)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->index = newIndex;
+    instance->indexCapacity = newCapacity;
+    instance->indexCount = 0;
+
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (oldIndex[i].pid)
+        {
+            job_collection_index_insert(
+                instance,
+                oldIndex[i].pid,
+                oldIndex[i].slot,
+                oldIndex[i].member);
+        }
+    }
+
+    free(oldIndex);
+
+    return 0;
+}
+
+static JobIndexEntry job_collection_index_find(
+    JobCollection instance,
+    pid_t pid)
+{
+    size_t i = job_collection_hash(instance, pid);
+
+    while (instance->index[i].pid)
+    {
+        if (instance->index[i].pid == pid)
+        {
+            return instance->index + i;
+        }
+
+        i = (i + 1) & (instance->indexCapacity - 1);
+    }
+
+    return NULL;
+}
+
+static void job_collection_index_remove(JobCollection instance, pid_t pid)
+{
+    JobIndexEntry entry = job_collection_index_find(instance, pid);
+
+    if (!entry)
+    {
+        return;
+    }
+
+    size_t mask = instance->indexCapacity - 1;
+    size_t hole = entry - instance->index;
+    size_t i = hole;
+
+    for (;;)
+    {
+        i = (i + 1) & mask;
+
+        if (!instance->index[i].pid)
+        {
+            break;
+        }
+
+        size_t home = job_collection_hash(instance, instance->index[i].pid);
+
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            instance->index[hole] = instance->index[i];
+            hole = i;
+        }
+    }
+
+    instance->index[hole].pid = 0;
+    instance->indexCount--;
+}
+
 Exception job_collection_add(
     JobCollection instance, 
-    pid_t pid,
-    Instruction first)
+    Job value,
+    size_t* result)
 {
     Exception ex = job_collection_ensure_capacity(
         instance, 
-        instance->count + 1);
+        instance->end + 1);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    ex = job_collection_index_ensure_capacity(
+        instance,
+        instance->indexCount + value->count);
 
     if (ex)
     {
         return ex;
     }
 
-    instance->items[instance->count].pid = pid;
-    instance->items[instance->count].first = first;
-    
-    if (instance->aliasReference)
+    struct Arena items;
+
+    arena(&items, 0);
+
+    pid_t* pids = arena_allocate(&items, value->count * sizeof * pids);
+    int* statuses = arena_allocate(&items, value->count * sizeof * statuses);
+    struct rusage* usages = arena_allocate(
+        &items,
+        value->count * sizeof * usages);
+    String text = arena_copy(&items, value->text, strlen(value->text));
+
+    if (!pids || !statuses || !usages || !text)
+    {
+        finalize_arena(&items);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    size_t slot = instance->end;
+
+    if (instance->vacancyCount)
+    {
+        instance->vacancyCount--;
+        slot = instance->vacancies[instance->vacancyCount];
+    }
+    else
+    {
+        instance->end++;
+    }
+
+    Job added = instance->items + slot;
+
+    memcpy(pids, value->pids, value->count * sizeof * pids);
+    memcpy(statuses, value->statuses, value->count * sizeof * statuses);
+    memcpy(usages, value->usages, value->count * sizeof * usages);
+
+    *added = *value;
+    added->pids = pids;
+    added->statuses = statuses;
+    added->usages = usages;
+    added->text = text;
+
+    arena_move(&added->arena, &items);
+
+    for (size_t i = 0; i < added->count; i++)
     {
-        if (*instance->aliasReference == first)
+        if (added->pids[i] > 0)
         {
-            *instance->aliasReference = NULL;
+            job_collection_index_insert(instance, added->pids[i], slot, i);
         }
     }
 
     instance->count++;
+    *result = slot + 1;
 
     return 0;
 }
 
-Exception job_collection_remove_at(JobCollection instance, size_t index)
+Job job_collection_get(JobCollection instance, size_t id)
 {
-    if (index >= instance->count)
+    if (id < 1 || id > instance->end || !instance->items[id - 1].text)
+    {
+        return NULL;
+    }
+
+    return instance->items + id - 1;
+}
+
+size_t job_collection_find(JobCollection instance, String value)
+{
+    if (value[0] == '%')
+    {
+        value++;
+    }
+
+    if (isdigit((unsigned char)value[0]))
+    {
+        char* end;
+        unsigned long long result = strtoull(value, &end, 10);
+
+        if (*end || !job_collection_get(instance, result))
+        {
+            return 0;
+        }
+
+        return result;
+    }
+
+    size_t length = strlen(value);
+    size_t result = 0;
+
+    if (!length)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < instance->end; i++)
+    {
+        String text = instance->items[i].text;
+
+        if (!text || strncmp(text, value, length) != 0)
+        {
+            continue;
+        }
+
+        if (result)
+        {
+            return 0;
+        }
+
+        result = i + 1;
+    }
+
+    return result;
+}
+
+Job job_collection_find_process(JobCollection instance, pid_t pid)
+{
+    JobIndexEntry entry = job_collection_index_find(instance, pid);
+
+    if (!entry)
+    {
+        return NULL;
+    }
+
+    return instance->items + entry->slot;
+}
+
+Exception job_collection_remove(JobCollection instance, size_t id)
+{
+    Job item = job_collection_get(instance, id);
+
+    if (!item)
     {
         return EXCEPTION_ARGUMENT_OUT_OF_RANGE;
     }
 
+    for (size_t i = 0; i < item->count; i++)
+    {
+        if (item->pids[i] > 0)
+        {
+            job_collection_index_remove(instance, item->pids[i]);
+        }
+    }
+
+    finalize_job(item);
+
+    item->text = NULL;
     instance->count--;
 
-    if (index == instance->count)
+    if (!instance->count)
     {
+        instance->end = 0;
+        instance->vacancyCount = 0;
+
         return 0;
     }
 
-    memmove(
-        instance->items + index, 
-        instance->items + index + 1, 
-        (instance->count - index) * sizeof * instance->items);
+    instance->vacancies[instance->vacancyCount] = id - 1;
+    instance->vacancyCount++;
 
     return 0;
 }
 
-void job_collection_free_instruction(JobCollection instance, Instruction value)
+// Records a process started after its job was added, as the parallel pool
+// does for each of its tasks.
+
+Exception job_collection_attach(
+    JobCollection instance,
+    size_t id,
+    size_t member,
+    pid_t pid)
 {
-    if (!instance->freeList)
+    Job item = job_collection_get(instance, id);
+
+    if (!item || member >= item->count)
     {
-        instance->freeList = value;
+        return EXCEPTION_ARGUMENT_OUT_OF_RANGE;
+    }
 
+    Exception ex = job_collection_index_ensure_capacity(
+        instance,
+        instance->indexCount + 1);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    item->pids[member] = pid;
+    item->statuses[member] = -1;
+
+    if (!item->group)
+    {
+        item->group = pid;
+    }
+
+    job_collection_index_insert(instance, pid, id - 1, member);
+
+    return 0;
+}
+
+static void job_collection_update(
+    JobCollection instance,
+    Job item,
+    pid_t pid,
+    int status,
+    const struct rusage* usage)
+{
+    if (job_update(item, pid, status, usage))
+    {
         return;
     }
 
-    instance->freeList->nextPipe = value;
+    JobIndexEntry entry = job_collection_index_find(instance, pid);
+
+    if (entry)
+    {
+        job_update_at(
+            instance->items + entry->slot,
+            entry->member,
+            status,
+            usage);
+    }
 }
 
-void job_collection_garbage_collect(JobCollection instance)
+void job_collection_wait(JobCollection instance, Job item)
 {
-    while (instance->freeList)
+    if (!item->running)
     {
-        Instruction next = instance->freeList->nextPipe;
+        return;
+    }
+
+    if (instance->terminal != -1)
+    {
+        tcsetpgrp(instance->terminal, item->group);
+    }
+
+    size_t stopped = 0;
+    uint64_t start = trace_now();
+
+    while (item->running > stopped)
+    {
+        int status;
+        struct rusage usage;
+        pid_t pid = wait4(
+            instance->subshell ? -1 : -item->group,
+            &status,
+            WUNTRACED,
+            &usage);
+
+        if (pid == -1)
+        {
+            euler_assert(errno == EINTR || errno == ECHILD);
+
+            if (errno == ECHILD)
+            {
+                item->running = 0;
+            }
+
+            continue;
+        }
+
+        trace_event(TRACE_WAIT, start, pid, status, NULL);
+
+        if (!WIFSTOPPED(status))
+        {
+            job_collection_update(instance, item, pid, status, &usage);
+
+            continue;
+        }
+
+        int stopSignal = WSTOPSIG(status);
+
+        if (instance->terminal != -1 &&
+            (stopSignal == SIGTTIN || stopSignal == SIGTTOU))
+        {
+            kill(pid, SIGCONT);
 
-        if (instance->freeList->text)
+            continue;
+        }
+
+        job_collection_update(instance, item, pid, status, &usage);
+
+        if (instance->subshell)
         {
-            free(instance->freeList->text);
-        
-            instance->freeList->text = NULL;
+            continue;
         }
 
-        free(instance->freeList);
+        if (!stopped && !instance->subshell)
+        {
+            killpg(item->group, SIGSTOP);
+        }
 
-        instance->freeList = next;
+        stopped++;
+    }
+
+    if (item->running)
+    {
+        item->state = JOB_STATE_STOPPED;
+    }
+    else
+    {
+        item->state = JOB_STATE_DONE;
+    }
+
+    if (instance->terminal != -1)
+    {
+        tcsetpgrp(instance->terminal, instance->group);
+        tcsetattr(instance->terminal, TCSADRAIN, &instance->modes);
+    }
+}
+
+void job_collection_on_child(EULER_UNUSED int signal)
+{
+    jobCollectionChanged = 1;
+}
+
+bool job_collection_changed(void)
+{
+    if (!jobCollectionChanged)
+    {
+        return false;
+    }
+
+    jobCollectionChanged = 0;
+
+    return true;
+}
+
+void job_collection_reap(JobCollection instance)
+{
+    int status;
+    int options = WCONTINUED | WNOHANG | WUNTRACED;
+    struct rusage usage;
+    pid_t pid;
+
+    while ((pid = wait4(-1, &status, options, &usage)) > 0)
+    {
+        trace_event(TRACE_WAIT, 0, pid, status, NULL);
+
+        JobIndexEntry entry = job_collection_index_find(instance, pid);
+
+        if (entry)
+        {
+            job_update_at(
+                instance->items + entry->slot,
+                entry->member,
+                status,
+                &usage);
+        }
     }
 }
 
 void finalize_job_collection(JobCollection instance)
 {
-    instance->count = 0;
+    for (size_t i = 0; i < instance->end; i++)
+    {
+        if (instance->items[i].text)
+        {
+            finalize_job(instance->items + i);
+        }
+    }
 
     free(instance->items);
-    job_collection_garbage_collect(instance);
+    free(instance->vacancies);
+    free(instance->index);
 
-    instance->items = NULL;
+    instance->count = 0;
+    instance->end = 0;
     instance->capacity = 0;
+    instance->items = NULL;
+    instance->vacancyCount = 0;
+    instance->vacancies = NULL;
+    instance->indexCount = 0;
+    instance->indexCapacity = 0;
+    instance->index = NULL;
 }
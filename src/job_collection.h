@@ -4,53 +4,162 @@
 
 #ifndef JOB_COLLECTION_1cb8a579912440e2b04aa4d31f016ed4
 #define JOB_COLLECTION_1cb8a579912440e2b04aa4d31f016ed4
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <termios.h>
+#include "arena.h"
 #include "euler.h"
+#define JOB_STATUS_NOT_FOUND (127 << 8)
 
-union InstructionPayload
+enum InstructionType
 {
-    char* argument;
-    char** arguments;
+    INSTRUCTION_COMMAND,
+    INSTRUCTION_SUBSHELL,
+    INSTRUCTION_PIPELINE,
+    INSTRUCTION_AND,
+    INSTRUCTION_OR,
+    INSTRUCTION_SEQUENCE,
+    INSTRUCTION_TIME,
+    INSTRUCTION_IF,
+    INSTRUCTION_WHILE,
+    INSTRUCTION_UNTIL,
+    INSTRUCTION_FOR
+};
+
+enum RedirectionType
+{
+    REDIRECTION_READ,
+    REDIRECTION_WRITE,
+    REDIRECTION_APPEND,
+    REDIRECTION_DUPLICATE,
+    REDIRECTION_DOCUMENT,
+    REDIRECTION_STRING
+};
+
+enum SubstitutionType
+{
+    SUBSTITUTION_INPUT,
+    SUBSTITUTION_OUTPUT,
+    SUBSTITUTION_COMMAND
+};
+
+struct Redirection
+{
+    enum RedirectionType type;
+    int descriptor;
+    char* word;
+    char* target;
+    struct Redirection* next;
+};
+
+struct Substitution
+{
+    enum SubstitutionType type;
+    char* word;
+    size_t length;
+    struct Instruction* instruction;
+    struct Substitution* next;
 };
 
-struct JobCollection;
+struct Parser;
 
 struct Instruction
 {
-    int descriptors[2];
+    enum InstructionType type;
     size_t length;
+    char** arguments;
+    size_t wordCount;
+    char** words;
+    size_t assignmentCount;
+    char** assignments;
+    char** variables;
     char* text;
-    char* read;
-    char* write;
-    char* append;
-    union InstructionPayload payload;
-    struct Instruction* nextPipe;
+    char* name;
+    struct Redirection* redirections;
+    struct Substitution* substitutions;
+    bool background;
+    size_t stageCount;
+    struct Instruction** stages;
+    struct Instruction* left;
+    struct Instruction* right;
+    struct Instruction* alternative;
 
-    bool (*execute)(struct JobCollection* jobs, struct Instruction* instance);
+    bool (*execute)(struct Parser* state, struct Instruction* instance);
+};
+
+enum JobState
+{
+    JOB_STATE_RUNNING,
+    JOB_STATE_STOPPED,
+    JOB_STATE_DONE
 };
 
 struct Job
+{
+    pid_t group;
+    size_t count;
+    size_t running;
+    pid_t* pids;
+    int* statuses;
+    struct rusage* usages;
+    enum JobState state;
+    char* text;
+    struct Arena arena;
+};
+
+struct JobIndexEntry
 {
     pid_t pid;
-    struct Instruction* first;
+    size_t slot;
+    size_t member;
 };
 
 struct JobCollection
 {
+    int terminal;
+    bool subshell;
+    pid_t group;
     size_t count;
+    size_t end;
     size_t capacity;
     struct Job* items;
-    struct Instruction* freeList;
-    struct Instruction** aliasReference;
+    size_t vacancyCount;
+    size_t* vacancies;
+    size_t indexCount;
+    size_t indexCapacity;
+    struct JobIndexEntry* index;
+    struct termios modes;
 };
 
+typedef enum InstructionType InstructionType;
+typedef enum RedirectionType RedirectionType;
+typedef enum SubstitutionType SubstitutionType;
+typedef enum JobState JobState;
+typedef struct Redirection* Redirection;
+typedef struct Substitution* Substitution;
 typedef struct Instruction* Instruction;
 typedef struct Job* Job;
+typedef struct JobIndexEntry* JobIndexEntry;
 typedef struct JobCollection* JobCollection;
 
-Exception job(Job instance, pid_t pid, Instruction first);
+void job(
+    Job instance,
+    String text,
+    pid_t pids[],
+    int statuses[],
+    struct rusage usages[],
+    size_t count);
+
+bool job_update(
+    Job instance,
+    pid_t pid,
+    int status,
+    const struct rusage* usage);
+
+void job_usage(Job instance, struct rusage* result);
+int job_status_code(int status);
 void finalize_job(Job instance);
 
 Exception job_collection(JobCollection instance, size_t capacity);
@@ -59,15 +168,33 @@ Exception job_collection_ensure_capacity(
     JobCollection instance,
     size_t capacity);
 
+void job_collection_control_terminal(JobCollection instance, int terminal);
+
 Exception job_collection_add(
     JobCollection instance,
-    pid_t value,
-    Instruction first);
+    Job value,
+    size_t* result);
+
+Job job_collection_get(JobCollection instance, size_t id);
+size_t job_collection_find(JobCollection instance, String value);
+Job job_collection_find_process(JobCollection instance, pid_t pid);
+Exception job_collection_remove(JobCollection instance, size_t id);
+
+Exception job_collection_attach(
+    JobCollection instance,
+    size_t id,
+    size_t member,
+    pid_t pid);
+
+void job_collection_wait(JobCollection instance, Job item);
+void job_collection_reap(JobCollection instance);
+
+// The SIGCHLD handler only sets a flag. The shell reaps its children before
+// each prompt and between loop iterations once the flag has been taken.
 
-Exception job_collection_remove_at(JobCollection instance, size_t index);
+void job_collection_on_child(int signal);
+bool job_collection_changed(void);
 
-void job_collection_free_instruction(JobCollection instance, Instruction value);
-void job_collection_garbage_collect(JobCollection instance);
 void finalize_job_collection(JobCollection instance);
 
 #endif
@@ -2,14 +2,112 @@
 // Copyright (c) 2024 Ishan Pranav
 // Licensed under the MIT license.
 
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/getrusage.2.html
+//  - https://www.gnu.org/software/bash/manual/html_node/Job-Control-Builtins.html
+
+#include <string.h>
 #include "handler.h"
 
-bool jobs_handler(JobCollection jobs, EULER_UNUSED Instruction instruction)
+static String jobs_handler_state(JobState value)
+{
+    switch (value)
+    {
+    case JOB_STATE_RUNNING: return "Running";
+    case JOB_STATE_STOPPED: return "Stopped";
+    default: return "Done";
+    }
+}
+
+static void jobs_handler_print_usage(const struct rusage* usage)
+{
+    printf(
+        " user %ld.%03lds sys %ld.%03lds",
+        (long)usage->ru_utime.tv_sec,
+        (long)usage->ru_utime.tv_usec / 1000,
+        (long)usage->ru_stime.tv_sec,
+        (long)usage->ru_stime.tv_usec / 1000);
+}
+
+static void jobs_handler_print_process(Job item, size_t member)
 {
-    for (size_t i = 0; i < jobs->count; i++)
+    int status = item->statuses[member];
+    const struct rusage* usage = item->usages + member;
+
+    printf("    %ld", (long)item->pids[member]);
+
+    if (status != -1)
     {
-        printf("[%zu] %s\n", i + 1, jobs->items[i].first->text);
+        printf(" Exit %d", job_status_code(status));
+    }
+    else if (item->state == JOB_STATE_RUNNING)
+    {
+        printf(" Running\n");
+
+        return;
     }
+    else
+    {
+        printf(" Stopped");
+    }
+
+    jobs_handler_print_usage(usage);
+    printf(
+        " maxrss %ldk faults %ld/%ld switches %ld/%ld\n",
+        usage->ru_maxrss,
+        usage->ru_majflt,
+        usage->ru_minflt,
+        usage->ru_nvcsw,
+        usage->ru_nivcsw);
+}
+
+bool jobs_handler(Parser state, Instruction instruction)
+{
+    JobCollection jobs = &state->jobs;
+    bool verbose = instruction->length == 2;
+
+    if (verbose && strcmp(instruction->arguments[1], "-l") != 0)
+    {
+        fprintf(stderr, "Error: invalid command\n");
+
+        state->status = 1;
+
+        return true;
+    }
+
+    for (size_t i = 0; i < jobs->end; i++)
+    {
+        Job item = jobs->items + i;
+
+        if (!item->text)
+        {
+            continue;
+        }
+
+        if (!verbose)
+        {
+            printf("[%zu] %s\n", i + 1, item->text);
+
+            continue;
+        }
+
+        struct rusage usage;
+
+        job_usage(item, &usage);
+        printf("[%zu] %s", i + 1, jobs_handler_state(item->state));
+        jobs_handler_print_usage(&usage);
+        printf(" %s\n", item->text);
+
+        for (size_t j = 0; j < item->count; j++)
+        {
+            if (item->pids[j] > 0)
+            {
+                jobs_handler_print_process(item, j);
+            }
+        }
+    }
+
+    state->status = 0;
 
     return true;
 }
@@ -0,0 +1,807 @@
+// lexer.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://en.wikipedia.org/wiki/Lexical_analysis
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "lexer.h"
+#define LEXER_DELIMITER 1
+#define LEXER_OPERATOR 2
+#define LEXER_QUOTE 4
+#define LEXER_INVALID 8
+
+static const unsigned char LEXER_CLASSES[256] =
+{
+    ['\t'] = LEXER_DELIMITER,
+    ['\n'] = LEXER_OPERATOR,
+    ['\r'] = LEXER_DELIMITER,
+    [' '] = LEXER_DELIMITER,
+    ['<'] = LEXER_OPERATOR,
+    ['>'] = LEXER_OPERATOR,
+    ['|'] = LEXER_OPERATOR,
+    ['&'] = LEXER_OPERATOR,
+    [';'] = LEXER_OPERATOR,
+    ['('] = LEXER_OPERATOR,
+    [')'] = LEXER_OPERATOR,
+    ['\''] = LEXER_QUOTE,
+    ['"'] = LEXER_QUOTE,
+    ['\\'] = LEXER_QUOTE,
+    ['`'] = LEXER_QUOTE
+};
+
+Exception lexer(Lexer instance, size_t capacity)
+{
+    if (capacity < 4)
+    {
+        capacity = 4;
+    }
+
+    instance->items = malloc(capacity * sizeof * instance->items);
+
+    if (!instance->items)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->count = 0;
+    instance->capacity = capacity;
+
+    return 0;
+}
+
+Exception lexer_ensure_capacity(Lexer instance, size_t capacity)
+{
+    if (instance->capacity >= capacity)
+    {
+        return 0;
+    }
+
+    size_t newCapacity = instance->capacity * 2;
+
+    if (capacity > newCapacity)
+    {
+        newCapacity = capacity;
+    }
+
+    struct Token* newItems = realloc(
+        instance->items,
+        newCapacity * sizeof * newItems);
+
+    if (!newItems)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->capacity = newCapacity;
+    instance->items = newItems;
+
+    return 0;
+}
+
+static size_t lexer_classify_operator(
+    const unsigned char* value,
+    const unsigned char* end,
+    Token result)
+{
+    result->descriptor = -1;
+
+    if (value + 2 < end && value[0] == '<' && value[1] == '<')
+    {
+        switch (value[2])
+        {
+        case '<':
+            result->symbol = SYMBOL_HERESTRING;
+            result->descriptor = STDIN_FILENO;
+
+            return 3;
+
+        case '-':
+            result->symbol = SYMBOL_HEREDOC;
+            result->descriptor = STDIN_FILENO;
+
+            return 3;
+        }
+    }
+
+    if (value + 1 < end)
+    {
+        switch (value[0] << 8 | value[1])
+        {
+        case '&' << 8 | '&':
+            result->symbol = SYMBOL_AND;
+
+            return 2;
+
+        case '|' << 8 | '|':
+            result->symbol = SYMBOL_OR;
+
+            return 2;
+
+        case '>' << 8 | '>':
+            result->symbol = SYMBOL_APPEND;
+            result->descriptor = STDOUT_FILENO;
+
+            return 2;
+
+        case '>' << 8 | '&':
+            result->symbol = SYMBOL_DUPLICATE;
+            result->descriptor = STDOUT_FILENO;
+
+            return 2;
+
+        case '<' << 8 | '&':
+            result->symbol = SYMBOL_DUPLICATE;
+            result->descriptor = STDIN_FILENO;
+
+            return 2;
+
+        case '<' << 8 | '<':
+            result->symbol = SYMBOL_HEREDOC;
+            result->descriptor = STDIN_FILENO;
+
+            return 2;
+        }
+    }
+
+    switch (value[0])
+    {
+    case '<':
+        result->symbol = SYMBOL_READ;
+        result->descriptor = STDIN_FILENO;
+        break;
+
+    case '>':
+        result->symbol = SYMBOL_WRITE;
+        result->descriptor = STDOUT_FILENO;
+        break;
+
+    case '|': result->symbol = SYMBOL_PIPE; break;
+    case '&': result->symbol = SYMBOL_AMPERSAND; break;
+    case '\n':
+    case ';': result->symbol = SYMBOL_SEMICOLON; break;
+    case '(': result->symbol = SYMBOL_OPEN; break;
+    case ')': result->symbol = SYMBOL_CLOSE; break;
+    }
+
+    return 1;
+}
+
+static Symbol lexer_classify_string(String value, size_t length)
+{
+    switch (length)
+    {
+    case 2:
+        if (memcmp(value, "cd", 2) == 0)
+        {
+            return SYMBOL_CHANGE_DIRECTORY;
+        }
+
+        if (memcmp(value, "fg", 2) == 0)
+        {
+            return SYMBOL_FOREGROUND;
+        }
+
+        if (memcmp(value, "bg", 2) == 0)
+        {
+            return SYMBOL_BACKGROUND;
+        }
+
+        if (memcmp(value, "if", 2) == 0)
+        {
+            return SYMBOL_IF;
+        }
+
+        if (memcmp(value, "fi", 2) == 0)
+        {
+            return SYMBOL_FI;
+        }
+
+        if (memcmp(value, "in", 2) == 0)
+        {
+            return SYMBOL_IN;
+        }
+
+        if (memcmp(value, "do", 2) == 0)
+        {
+            return SYMBOL_DO;
+        }
+
+        break;
+
+    case 3:
+        if (memcmp(value, "for", 3) == 0)
+        {
+            return SYMBOL_FOR;
+        }
+
+        break;
+
+    case 4:
+        if (memcmp(value, "exit", 4) == 0)
+        {
+            return SYMBOL_EXIT;
+        }
+
+        if (memcmp(value, "jobs", 4) == 0)
+        {
+            return SYMBOL_JOBS;
+        }
+
+        if (memcmp(value, "hash", 4) == 0)
+        {
+            return SYMBOL_HASH;
+        }
+
+        if (memcmp(value, "time", 4) == 0)
+        {
+            return SYMBOL_TIME;
+        }
+
+        if (memcmp(value, "then", 4) == 0)
+        {
+            return SYMBOL_THEN;
+        }
+
+        if (memcmp(value, "elif", 4) == 0)
+        {
+            return SYMBOL_ELIF;
+        }
+
+        if (memcmp(value, "else", 4) == 0)
+        {
+            return SYMBOL_ELSE;
+        }
+
+        if (memcmp(value, "done", 4) == 0)
+        {
+            return SYMBOL_DONE;
+        }
+
+        break;
+
+    case 5:
+        if (memcmp(value, "while", 5) == 0)
+        {
+            return SYMBOL_WHILE;
+        }
+
+        if (memcmp(value, "until", 5) == 0)
+        {
+            return SYMBOL_UNTIL;
+        }
+
+        break;
+    }
+
+    return SYMBOL_STRING;
+}
+
+static const unsigned char* lexer_scan_substitution(
+    const unsigned char* p,
+    const unsigned char* end);
+
+static const unsigned char* lexer_scan_quote(
+    const unsigned char* p,
+    const unsigned char* end)
+{
+    unsigned char quote = *p;
+
+    for (p++; p < end; p++)
+    {
+        if (*p == quote)
+        {
+            return p + 1;
+        }
+
+        if (quote != '\'' && *p == '\\' && p + 1 < end)
+        {
+            p++;
+        }
+        else if (quote == '"' && *p == '$' && p + 1 < end && p[1] == '(')
+        {
+            p = lexer_scan_substitution(p + 1, end);
+
+            if (!p)
+            {
+                return NULL;
+            }
+
+            p--;
+        }
+    }
+
+    return NULL;
+}
+
+static const unsigned char* lexer_scan_substitution(
+    const unsigned char* p,
+    const unsigned char* end)
+{
+    size_t depth = 0;
+
+    while (p < end)
+    {
+        switch (*p)
+        {
+        case '(':
+            depth++;
+            p++;
+            break;
+
+        case ')':
+            depth--;
+            p++;
+
+            if (!depth)
+            {
+                return p;
+            }
+
+            break;
+
+        case '\\':
+            p += 1 + (p + 1 < end);
+            break;
+
+        case '\'':
+        case '"':
+            p = lexer_scan_quote(p, end);
+
+            if (!p)
+            {
+                return NULL;
+            }
+
+            break;
+
+        default:
+            p++;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+size_t lexer_measure_substitution(String value, size_t length)
+{
+    const unsigned char* start = (const unsigned char*)value;
+    const unsigned char* end = lexer_scan_substitution(start, start + length);
+
+    if (!end)
+    {
+        return 0;
+    }
+
+    return end - start;
+}
+
+static bool lexer_is_delimiter(
+    const unsigned char* line,
+    const unsigned char* end,
+    Token delimiter)
+{
+    const unsigned char* p = (const unsigned char*)delimiter->value;
+    const unsigned char* last = p + delimiter->length;
+
+    for (; p < last; p++)
+    {
+        if (*p == '\'' || *p == '"')
+        {
+            continue;
+        }
+
+        if (*p == '\\' && p + 1 < last)
+        {
+            p++;
+        }
+
+        if (line == end || *line != *p)
+        {
+            return false;
+        }
+
+        line++;
+    }
+
+    return line == end;
+}
+
+// Here-document bodies start on the line after the operator. Each body is
+// stored in the placeholder token that follows its delimiter, and is left
+// null when the text ends before the delimiter line.
+
+static const unsigned char* lexer_read_documents(
+    Lexer instance,
+    size_t documents[],
+    size_t count,
+    const unsigned char* p,
+    const unsigned char* end)
+{
+    for (size_t i = 0; i < count && p < end; i++)
+    {
+        Token document = instance->items + documents[i];
+        bool strip = document[-2].length == 3;
+        const unsigned char* start = p;
+
+        while (p < end)
+        {
+            const unsigned char* line = p;
+
+            while (strip && line < end && *line == '\t')
+            {
+                line++;
+            }
+
+            const unsigned char* next = memchr(line, '\n', end - line);
+
+            if (!next)
+            {
+                next = end;
+            }
+
+            bool found = lexer_is_delimiter(line, next, document - 1);
+            const unsigned char* body = p;
+
+            p = next + (next < end);
+
+            if (found)
+            {
+                document->value = (String)start;
+                document->length = body - start;
+
+                break;
+            }
+        }
+    }
+
+    return p;
+}
+
+Exception lexer_tokenize(Lexer instance, String value, size_t length)
+{
+    const unsigned char* p = (const unsigned char*)value;
+    const unsigned char* end = p + length;
+    int descriptor = -1;
+    size_t documents[LEXER_MAX_DOCUMENTS];
+    size_t documentCount = 0;
+    bool delimiter = false;
+
+    instance->count = 0;
+
+    for (;;)
+    {
+        while (p < end && LEXER_CLASSES[*p] & LEXER_DELIMITER)
+        {
+            p++;
+        }
+
+        if (p < end && *p == '#')
+        {
+            p = memchr(p, '\n', end - p);
+
+            if (!p)
+            {
+                p = end;
+            }
+        }
+
+        if (p == end)
+        {
+            break;
+        }
+
+        Exception ex = lexer_ensure_capacity(instance, instance->count + 2);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        Token token = instance->items + instance->count;
+
+        token->value = (String)p;
+
+        if ((*p == '<' || *p == '>') && p + 1 < end && p[1] == '(')
+        {
+            const unsigned char* next = lexer_scan_substitution(p + 1, end);
+
+            token->symbol = next ? SYMBOL_STRING : SYMBOL_INVALID;
+            token->descriptor = -1;
+            p = next ? next : end;
+            token->length = (String)p - token->value;
+            delimiter = false;
+            instance->count++;
+
+            continue;
+        }
+
+        if (LEXER_CLASSES[*p] & LEXER_OPERATOR)
+        {
+            p += lexer_classify_operator(p, end, token);
+            token->length = (String)p - token->value;
+
+            if (descriptor != -1)
+            {
+                token->descriptor = descriptor;
+                descriptor = -1;
+            }
+
+            instance->count++;
+            delimiter = token->symbol == SYMBOL_HEREDOC;
+
+            if (*token->value == '\n' && documentCount)
+            {
+                p = lexer_read_documents(
+                    instance,
+                    documents,
+                    documentCount,
+                    p,
+                    end);
+                documentCount = 0;
+            }
+
+            continue;
+        }
+
+        unsigned char classes = 0;
+
+        while (p < end &&
+            !(LEXER_CLASSES[*p] & (LEXER_DELIMITER | LEXER_OPERATOR)))
+        {
+            classes |= LEXER_CLASSES[*p];
+
+            if (*p == '\\')
+            {
+                p += 1 + (p + 1 < end);
+            }
+            else if (*p == '$' && p + 1 < end && p[1] == '(')
+            {
+                p = lexer_scan_substitution(p + 1, end);
+
+                if (!p)
+                {
+                    classes |= LEXER_INVALID;
+                    p = end;
+                }
+            }
+            else if (LEXER_CLASSES[*p] & LEXER_QUOTE)
+            {
+                p = lexer_scan_quote(p, end);
+
+                if (!p)
+                {
+                    classes |= LEXER_INVALID;
+                    p = end;
+                }
+            }
+            else
+            {
+                p++;
+            }
+        }
+
+        token->length = (String)p - token->value;
+        token->descriptor = -1;
+
+        if (classes & LEXER_INVALID)
+        {
+            token->symbol = SYMBOL_INVALID;
+        }
+        else if (classes)
+        {
+            token->symbol = SYMBOL_STRING;
+        }
+        else if (token->length == 1 &&
+            isdigit((unsigned char)token->value[0]) &&
+            p < end &&
+            (*p == '<' || *p == '>'))
+        {
+            descriptor = token->value[0] - '0';
+
+            continue;
+        }
+        else
+        {
+            token->symbol = lexer_classify_string(token->value, token->length);
+        }
+
+        instance->count++;
+
+        if (!delimiter)
+        {
+            continue;
+        }
+
+        delimiter = false;
+
+        if (documentCount == LEXER_MAX_DOCUMENTS)
+        {
+            token->symbol = SYMBOL_INVALID;
+
+            continue;
+        }
+
+        Token document = instance->items + instance->count;
+
+        document->value = NULL;
+        document->length = 0;
+        document->descriptor = -1;
+        document->symbol = SYMBOL_DOCUMENT;
+        documents[documentCount] = instance->count;
+        documentCount++;
+        instance->count++;
+    }
+
+    return 0;
+}
+
+void lexer_clear(Lexer instance)
+{
+    instance->count = 0;
+}
+
+void finalize_lexer(Lexer instance)
+{
+    instance->count = 0;
+
+    free(instance->items);
+
+    instance->items = NULL;
+    instance->capacity = 0;
+}
+
+static bool lexer_is_word(Symbol symbol)
+{
+    return symbol == SYMBOL_STRING ||
+        (symbol >= SYMBOL_CHANGE_DIRECTORY && symbol <= SYMBOL_DONE);
+}
+
+void lexer_continuation_clear(LexerContinuation instance)
+{
+    instance->depth = 0;
+    instance->first = 0;
+    instance->count = 0;
+}
+
+// Keywords only open or close a compound command where a command may
+// start. Every line starts a command, because newlines separate commands.
+// While here-document delimiters are expected, each line is compared with
+// the next delimiter instead of being tokenized.
+
+Exception lexer_continuation_add(
+    LexerContinuation instance,
+    String text,
+    size_t start,
+    size_t length,
+    bool* complete)
+{
+    if (instance->first < instance->count)
+    {
+        LexerDocument document = instance->documents + instance->first;
+        const unsigned char* line = (const unsigned char*)text + start;
+        const unsigned char* end = line + length;
+        struct Token delimiter =
+        {
+            .value = text + document->offset,
+            .length = document->length
+        };
+
+        while (document->strip && line < end && *line == '\t')
+        {
+            line++;
+        }
+
+        if (lexer_is_delimiter(line, end, &delimiter))
+        {
+            instance->first++;
+        }
+
+        *complete = instance->first == instance->count && instance->depth <= 0;
+
+        return 0;
+    }
+
+    Lexer lexer = &instance->lexer;
+    Exception ex = lexer_tokenize(lexer, text + start, length);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    bool command = true;
+
+    instance->first = 0;
+    instance->count = 0;
+
+    for (size_t i = 0; i < lexer->count; i++)
+    {
+        switch (lexer->items[i].symbol)
+        {
+        case SYMBOL_IF:
+        case SYMBOL_WHILE:
+        case SYMBOL_UNTIL:
+        case SYMBOL_FOR:
+            if (command)
+            {
+                instance->depth++;
+            }
+
+            command = command && lexer->items[i].symbol != SYMBOL_FOR;
+            break;
+
+        case SYMBOL_FI:
+        case SYMBOL_DONE:
+            if (command)
+            {
+                instance->depth--;
+            }
+
+            break;
+
+        case SYMBOL_TIME:
+        case SYMBOL_THEN:
+        case SYMBOL_ELIF:
+        case SYMBOL_ELSE:
+        case SYMBOL_DO:
+        case SYMBOL_DOCUMENT:
+            break;
+
+        case SYMBOL_PIPE:
+        case SYMBOL_AMPERSAND:
+        case SYMBOL_SEMICOLON:
+        case SYMBOL_AND:
+        case SYMBOL_OR:
+        case SYMBOL_OPEN:
+        case SYMBOL_CLOSE:
+            command = true;
+            break;
+
+        case SYMBOL_HEREDOC:
+            if (i + 1 < lexer->count &&
+                lexer_is_word(lexer->items[i + 1].symbol) &&
+                instance->count < LEXER_MAX_DOCUMENTS)
+            {
+                LexerDocument document = instance->documents +
+                    instance->count;
+
+                document->offset = lexer->items[i + 1].value - text;
+                document->length = lexer->items[i + 1].length;
+                document->strip = lexer->items[i].length == 3;
+                instance->count++;
+            }
+
+            i++;
+            break;
+
+        case SYMBOL_READ:
+        case SYMBOL_WRITE:
+        case SYMBOL_APPEND:
+        case SYMBOL_DUPLICATE:
+        case SYMBOL_HERESTRING:
+            i++;
+            break;
+
+        default:
+            command = false;
+            break;
+        }
+    }
+
+    *complete = !instance->count && instance->depth <= 0;
+
+    return 0;
+}
+
+void finalize_lexer_continuation(LexerContinuation instance)
+{
+    finalize_lexer(&instance->lexer);
+}
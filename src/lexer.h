@@ -0,0 +1,75 @@
+// lexer.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://en.wikipedia.org/wiki/Lexical_analysis
+
+#ifndef LEXER_19fa9b8ff3614319b85c9356bfe1c151
+#define LEXER_19fa9b8ff3614319b85c9356bfe1c151
+#include <stdbool.h>
+#include <stddef.h>
+#include "euler.h"
+#include "symbol.h"
+#define LEXER_MAX_DOCUMENTS 16
+
+struct Token
+{
+    char* value;
+    size_t length;
+    int descriptor;
+    enum Symbol symbol;
+};
+
+struct Lexer
+{
+    size_t count;
+    size_t capacity;
+    struct Token* items;
+};
+
+struct LexerDocument
+{
+    size_t offset;
+    size_t length;
+    bool strip;
+};
+
+// Follows a command that spans lines one line at a time, counting the
+// compound commands left open and the here-document delimiters still
+// expected, so that the shell parses the text again only once a line might
+// complete it.
+
+struct LexerContinuation
+{
+    struct Lexer lexer;
+    long depth;
+    size_t first;
+    size_t count;
+    struct LexerDocument documents[LEXER_MAX_DOCUMENTS];
+};
+
+typedef struct Token* Token;
+typedef struct Lexer* Lexer;
+typedef struct LexerDocument* LexerDocument;
+typedef struct LexerContinuation* LexerContinuation;
+
+Exception lexer(Lexer instance, size_t capacity);
+
+Exception lexer_ensure_capacity(Lexer instance, size_t capacity);
+Exception lexer_tokenize(Lexer instance, String value, size_t length);
+size_t lexer_measure_substitution(String value, size_t length);
+void lexer_clear(Lexer instance);
+void finalize_lexer(Lexer instance);
+void lexer_continuation_clear(LexerContinuation instance);
+
+Exception lexer_continuation_add(
+    LexerContinuation instance,
+    String text,
+    size_t start,
+    size_t length,
+    bool* complete);
+
+void finalize_lexer_continuation(LexerContinuation instance);
+
+#endif
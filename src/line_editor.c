@@ -0,0 +1,735 @@
+// line_editor.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man3/termios.3.html
+//  - https://www.man7.org/linux/man-pages/man3/open_memstream.3.html
+//  - https://en.wikipedia.org/wiki/ANSI_escape_code
+//  - https://www.gnu.org/software/bash/manual/html_node/Commands-For-History.html
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "line_editor.h"
+#include "stream.h"
+#define LINE_EDITOR_CONTROL(key) ((key) & 0x1f)
+#define LINE_EDITOR_ESCAPE 0x1b
+#define LINE_EDITOR_BACKSPACE 0x7f
+#define LINE_EDITOR_QUERY 256
+
+enum LineEditorKey
+{
+    LINE_EDITOR_KEY_END_OF_FILE = -1,
+    LINE_EDITOR_KEY_UP = 256,
+    LINE_EDITOR_KEY_DOWN,
+    LINE_EDITOR_KEY_RIGHT,
+    LINE_EDITOR_KEY_LEFT,
+    LINE_EDITOR_KEY_HOME,
+    LINE_EDITOR_KEY_END,
+    LINE_EDITOR_KEY_DELETE,
+    LINE_EDITOR_KEY_UNKNOWN
+};
+
+Exception line_editor(LineEditor instance, int descriptor, History history)
+{
+    Exception ex = completion(&instance->completion);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    instance->capacity = 80;
+    instance->buffer = malloc(instance->capacity);
+
+    if (!instance->buffer)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->descriptor = descriptor;
+    instance->length = 0;
+    instance->cursor = 0;
+    instance->draft = NULL;
+    instance->browse = 0;
+    instance->prompt = NULL;
+    instance->history = history;
+
+    return 0;
+}
+
+static int line_editor_byte(LineEditor instance)
+{
+    unsigned char result;
+
+    for (;;)
+    {
+        ssize_t count = read(instance->descriptor, &result, 1);
+
+        if (count == 1)
+        {
+            return result;
+        }
+
+        if (count == -1 && errno == EINTR)
+        {
+            continue;
+        }
+
+        return LINE_EDITOR_KEY_END_OF_FILE;
+    }
+}
+
+static int line_editor_key(LineEditor instance)
+{
+    int result = line_editor_byte(instance);
+
+    if (result != LINE_EDITOR_ESCAPE)
+    {
+        return result;
+    }
+
+    int introducer = line_editor_byte(instance);
+    int final = line_editor_byte(instance);
+
+    if (introducer == 'O')
+    {
+        switch (final)
+        {
+        case 'H': return LINE_EDITOR_KEY_HOME;
+        case 'F': return LINE_EDITOR_KEY_END;
+        }
+
+        return LINE_EDITOR_KEY_UNKNOWN;
+    }
+
+    if (introducer != '[')
+    {
+        return LINE_EDITOR_KEY_UNKNOWN;
+    }
+
+    switch (final)
+    {
+    case 'A': return LINE_EDITOR_KEY_UP;
+    case 'B': return LINE_EDITOR_KEY_DOWN;
+    case 'C': return LINE_EDITOR_KEY_RIGHT;
+    case 'D': return LINE_EDITOR_KEY_LEFT;
+    case 'H': return LINE_EDITOR_KEY_HOME;
+    case 'F': return LINE_EDITOR_KEY_END;
+    }
+
+    if (final < '0' || final > '9')
+    {
+        return LINE_EDITOR_KEY_UNKNOWN;
+    }
+
+    int terminator = line_editor_byte(instance);
+
+    while (terminator >= '0' && terminator <= ';')
+    {
+        terminator = line_editor_byte(instance);
+    }
+
+    if (terminator != '~')
+    {
+        return LINE_EDITOR_KEY_UNKNOWN;
+    }
+
+    switch (final)
+    {
+    case '1':
+    case '7':
+        return LINE_EDITOR_KEY_HOME;
+
+    case '3': return LINE_EDITOR_KEY_DELETE;
+
+    case '4':
+    case '8':
+        return LINE_EDITOR_KEY_END;
+    }
+
+    return LINE_EDITOR_KEY_UNKNOWN;
+}
+
+static void line_editor_write(LineEditor instance, String value)
+{
+    stream_write(instance->descriptor, value, strlen(value));
+}
+
+static void line_editor_render(LineEditor instance)
+{
+    char* output;
+    size_t length;
+    FILE* stream = open_memstream(&output, &length);
+
+    euler_assert(stream);
+    fprintf(
+        stream,
+        "\r%s%.*s\x1b[K\r",
+        instance->prompt,
+        (int)instance->length,
+        instance->buffer);
+
+    size_t column = strlen(instance->prompt) + instance->cursor;
+
+    if (column)
+    {
+        fprintf(stream, "\x1b[%zuC", column);
+    }
+
+    euler_assert(fclose(stream) == 0);
+    stream_write(instance->descriptor, output, length);
+    free(output);
+}
+
+static void line_editor_ensure_capacity(LineEditor instance, size_t capacity)
+{
+    if (instance->capacity >= capacity)
+    {
+        return;
+    }
+
+    size_t newCapacity = instance->capacity * 2;
+
+    if (capacity > newCapacity)
+    {
+        newCapacity = capacity;
+    }
+
+    String newBuffer = realloc(instance->buffer, newCapacity);
+
+    euler_assert(newBuffer);
+
+    instance->capacity = newCapacity;
+    instance->buffer = newBuffer;
+}
+
+static void line_editor_insert(LineEditor instance, String value, size_t length)
+{
+    line_editor_ensure_capacity(instance, instance->length + length + 1);
+    memmove(
+        instance->buffer + instance->cursor + length,
+        instance->buffer + instance->cursor,
+        instance->length - instance->cursor);
+    memcpy(instance->buffer + instance->cursor, value, length);
+
+    instance->length += length;
+    instance->cursor += length;
+}
+
+static void line_editor_erase(LineEditor instance, size_t start, size_t end)
+{
+    memmove(
+        instance->buffer + start,
+        instance->buffer + end,
+        instance->length - end);
+
+    instance->length -= end - start;
+
+    if (instance->cursor >= end)
+    {
+        instance->cursor -= end - start;
+    }
+    else if (instance->cursor > start)
+    {
+        instance->cursor = start;
+    }
+}
+
+static void line_editor_set(LineEditor instance, String value, size_t length)
+{
+    instance->length = 0;
+    instance->cursor = 0;
+
+    line_editor_insert(instance, value, length);
+}
+
+static void line_editor_browse(LineEditor instance, int direction)
+{
+    size_t count;
+
+    euler_ok(history_count(instance->history, &count));
+
+    size_t browse = instance->browse;
+
+    if (!browse)
+    {
+        browse = count + 1;
+    }
+
+    if (direction < 0 ? browse <= 1 : browse > count)
+    {
+        return;
+    }
+
+    browse += direction;
+
+    if (browse > count)
+    {
+        instance->browse = 0;
+
+        if (instance->draft)
+        {
+            line_editor_set(instance, instance->draft, strlen(instance->draft));
+            free(instance->draft);
+
+            instance->draft = NULL;
+        }
+
+        return;
+    }
+
+    String text;
+    size_t length;
+
+    if (!history_get(instance->history, browse, &text, &length))
+    {
+        return;
+    }
+
+    if (!instance->browse)
+    {
+        free(instance->draft);
+
+        instance->draft = malloc(instance->length + 1);
+
+        euler_assert(instance->draft);
+        memcpy(instance->draft, instance->buffer, instance->length);
+
+        instance->draft[instance->length] = '\0';
+    }
+
+    instance->browse = browse;
+
+    line_editor_set(instance, text, length);
+}
+
+static int line_editor_search(LineEditor instance)
+{
+    char query[LINE_EDITOR_QUERY];
+    size_t queryLength = 0;
+    size_t match = 0;
+    size_t originalLength = instance->length;
+    String original = malloc(originalLength + 1);
+
+    euler_assert(original);
+    memcpy(original, instance->buffer, originalLength);
+
+    for (;;)
+    {
+        String text = "";
+        size_t length = 0;
+
+        if (match)
+        {
+            history_get(instance->history, match, &text, &length);
+        }
+
+        char* output;
+        size_t outputLength;
+        FILE* stream = open_memstream(&output, &outputLength);
+
+        euler_assert(stream);
+        fprintf(
+            stream,
+            "\r(reverse-i-search)`%.*s': %.*s\x1b[K",
+            (int)queryLength,
+            query,
+            (int)length,
+            text);
+        euler_assert(fclose(stream) == 0);
+        stream_write(instance->descriptor, output, outputLength);
+        free(output);
+
+        int key = line_editor_key(instance);
+        size_t before = match;
+
+        if (key == LINE_EDITOR_CONTROL('r'))
+        {
+            if (!match)
+            {
+                continue;
+            }
+        }
+        else if (key == LINE_EDITOR_BACKSPACE ||
+            key == LINE_EDITOR_CONTROL('h'))
+        {
+            if (queryLength)
+            {
+                queryLength--;
+            }
+
+            before = 0;
+        }
+        else if (key >= ' ' && key < LINE_EDITOR_BACKSPACE)
+        {
+            if (queryLength + 1 < sizeof query)
+            {
+                query[queryLength] = key;
+                queryLength++;
+            }
+
+            if (before)
+            {
+                before++;
+            }
+        }
+        else
+        {
+            if (key == LINE_EDITOR_CONTROL('g') ||
+                key == LINE_EDITOR_CONTROL('c') ||
+                key == LINE_EDITOR_KEY_END_OF_FILE)
+            {
+                line_editor_set(instance, original, originalLength);
+            }
+            else
+            {
+                line_editor_set(instance, text, length);
+            }
+
+            free(original);
+
+            return key;
+        }
+
+        query[queryLength] = '\0';
+
+        size_t result = 0;
+
+        euler_ok(history_search(instance->history, query, before, &result));
+
+        if (result || key != LINE_EDITOR_CONTROL('r'))
+        {
+            match = result;
+        }
+    }
+}
+
+static bool line_editor_is_operator(char value)
+{
+    return value == '|' || value == '<' || value == '>' || value == '&';
+}
+
+static bool line_editor_is_delimiter(char value)
+{
+    return value == ' ' || value == '\t' || line_editor_is_operator(value);
+}
+
+static int line_editor_compare(const void* left, const void* right)
+{
+    return strcmp(*(String*)left, *(String*)right);
+}
+
+static void line_editor_complete(LineEditor instance, bool list)
+{
+    size_t start = instance->cursor;
+
+    while (start && !line_editor_is_delimiter(instance->buffer[start - 1]))
+    {
+        start--;
+    }
+
+    size_t previous = start;
+
+    while (previous && (instance->buffer[previous - 1] == ' ' ||
+        instance->buffer[previous - 1] == '\t'))
+    {
+        previous--;
+    }
+
+    bool command = !previous || instance->buffer[previous - 1] == '|';
+    Completion completion = &instance->completion;
+
+    euler_ok(completion_find(
+        completion,
+        instance->buffer + start,
+        instance->cursor - start,
+        command));
+
+    ArgumentVector candidates = &completion->candidates;
+
+    if (!candidates->count)
+    {
+        line_editor_write(instance, "\a");
+
+        return;
+    }
+
+    String first = candidates->buffer[0];
+    size_t common = strlen(first);
+
+    for (size_t i = 1; i < candidates->count; i++)
+    {
+        size_t j = 0;
+
+        while (j < common && candidates->buffer[i][j] == first[j])
+        {
+            j++;
+        }
+
+        common = j;
+    }
+
+    size_t wordLength = instance->cursor - start;
+
+    if (common > wordLength)
+    {
+        line_editor_erase(instance, start, instance->cursor);
+        line_editor_insert(instance, first, common);
+
+        if (candidates->count == 1 && first[common - 1] != '/')
+        {
+            line_editor_insert(instance, " ", 1);
+        }
+
+        return;
+    }
+
+    if (candidates->count == 1)
+    {
+        return;
+    }
+
+    if (!list)
+    {
+        line_editor_write(instance, "\a");
+
+        return;
+    }
+
+    qsort(
+        candidates->buffer,
+        candidates->count,
+        sizeof * candidates->buffer,
+        line_editor_compare);
+
+    char* output;
+    size_t length;
+    FILE* stream = open_memstream(&output, &length);
+
+    euler_assert(stream);
+    fputs("\r\n", stream);
+
+    for (size_t i = 0; i < candidates->count; i++)
+    {
+        fprintf(stream, "%s  ", candidates->buffer[i]);
+    }
+
+    fputs("\r\n", stream);
+    euler_assert(fclose(stream) == 0);
+    stream_write(instance->descriptor, output, length);
+    free(output);
+}
+
+static void line_editor_raw(LineEditor instance)
+{
+    struct termios modes = instance->modes;
+
+    modes.c_iflag &= ~(ICRNL | IXON);
+    modes.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    modes.c_cc[VMIN] = 1;
+    modes.c_cc[VTIME] = 0;
+
+    tcsetattr(instance->descriptor, TCSADRAIN, &modes);
+}
+
+ssize_t line_editor_read(LineEditor instance, String prompt, String* result)
+{
+    if (tcgetattr(instance->descriptor, &instance->modes) == -1)
+    {
+        return -1;
+    }
+
+    line_editor_raw(instance);
+
+    instance->prompt = prompt;
+    instance->length = 0;
+    instance->cursor = 0;
+    instance->browse = 0;
+
+    int previous = 0;
+    ssize_t length = -1;
+
+    line_editor_render(instance);
+
+    for (;;)
+    {
+        int key = line_editor_key(instance);
+
+        if (key == LINE_EDITOR_CONTROL('r'))
+        {
+            key = line_editor_search(instance);
+        }
+
+        if (key == '\r' || key == '\n')
+        {
+            line_editor_render(instance);
+            line_editor_write(instance, "\r\n");
+
+            length = instance->length;
+
+            break;
+        }
+
+        if (key == LINE_EDITOR_KEY_END_OF_FILE ||
+            (key == LINE_EDITOR_CONTROL('d') && !instance->length))
+        {
+            line_editor_write(instance, "\r\n");
+
+            break;
+        }
+
+        switch (key)
+        {
+        case LINE_EDITOR_CONTROL('a'):
+        case LINE_EDITOR_KEY_HOME:
+            instance->cursor = 0;
+            break;
+
+        case LINE_EDITOR_CONTROL('e'):
+        case LINE_EDITOR_KEY_END:
+            instance->cursor = instance->length;
+            break;
+
+        case LINE_EDITOR_CONTROL('b'):
+        case LINE_EDITOR_KEY_LEFT:
+            if (instance->cursor)
+            {
+                instance->cursor--;
+            }
+
+            break;
+
+        case LINE_EDITOR_CONTROL('f'):
+        case LINE_EDITOR_KEY_RIGHT:
+            if (instance->cursor < instance->length)
+            {
+                instance->cursor++;
+            }
+
+            break;
+
+        case LINE_EDITOR_CONTROL('p'):
+        case LINE_EDITOR_KEY_UP:
+            line_editor_browse(instance, -1);
+            break;
+
+        case LINE_EDITOR_CONTROL('n'):
+        case LINE_EDITOR_KEY_DOWN:
+            line_editor_browse(instance, 1);
+            break;
+
+        case LINE_EDITOR_CONTROL('h'):
+        case LINE_EDITOR_BACKSPACE:
+            if (instance->cursor)
+            {
+                line_editor_erase(
+                    instance,
+                    instance->cursor - 1,
+                    instance->cursor);
+            }
+
+            break;
+
+        case LINE_EDITOR_CONTROL('d'):
+        case LINE_EDITOR_KEY_DELETE:
+            if (instance->cursor < instance->length)
+            {
+                line_editor_erase(
+                    instance,
+                    instance->cursor,
+                    instance->cursor + 1);
+            }
+
+            break;
+
+        case LINE_EDITOR_CONTROL('k'):
+            instance->length = instance->cursor;
+            break;
+
+        case LINE_EDITOR_CONTROL('u'):
+            line_editor_erase(instance, 0, instance->cursor);
+            break;
+
+        case LINE_EDITOR_CONTROL('w'):
+        {
+            size_t start = instance->cursor;
+
+            while (start && instance->buffer[start - 1] == ' ')
+            {
+                start--;
+            }
+
+            while (start && instance->buffer[start - 1] != ' ')
+            {
+                start--;
+            }
+
+            line_editor_erase(instance, start, instance->cursor);
+            break;
+        }
+
+        case LINE_EDITOR_CONTROL('c'):
+            line_editor_write(instance, "^C\r\n");
+
+            instance->length = 0;
+            instance->cursor = 0;
+            instance->browse = 0;
+            break;
+
+        case LINE_EDITOR_CONTROL('l'):
+            line_editor_write(instance, "\x1b[H\x1b[2J");
+            break;
+
+        case '\t':
+            line_editor_complete(instance, previous == '\t');
+            break;
+
+        default:
+            if (key >= ' ' && key < LINE_EDITOR_BACKSPACE)
+            {
+                char value = key;
+
+                line_editor_insert(instance, &value, 1);
+            }
+
+            break;
+        }
+
+        previous = key;
+
+        line_editor_render(instance);
+    }
+
+    tcsetattr(instance->descriptor, TCSADRAIN, &instance->modes);
+    free(instance->draft);
+
+    instance->draft = NULL;
+
+    if (length == -1)
+    {
+        return -1;
+    }
+
+    line_editor_ensure_capacity(instance, instance->length + 1);
+
+    instance->buffer[instance->length] = '\0';
+    *result = instance->buffer;
+
+    return length;
+}
+
+void finalize_line_editor(LineEditor instance)
+{
+    finalize_completion(&instance->completion);
+    free(instance->buffer);
+    free(instance->draft);
+
+    instance->buffer = NULL;
+    instance->draft = NULL;
+    instance->capacity = 0;
+    instance->length = 0;
+}
@@ -0,0 +1,39 @@
+// line_editor.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man3/termios.3.html
+//  - https://en.wikipedia.org/wiki/ANSI_escape_code
+
+#ifndef LINE_EDITOR_3d9e6f2a1b7c4c5e8f0a2b4d6c8e1f3a
+#define LINE_EDITOR_3d9e6f2a1b7c4c5e8f0a2b4d6c8e1f3a
+#include <sys/types.h>
+#include <stddef.h>
+#include <termios.h>
+#include "completion.h"
+#include "euler.h"
+#include "history.h"
+
+struct LineEditor
+{
+    int descriptor;
+    size_t length;
+    size_t capacity;
+    size_t cursor;
+    char* buffer;
+    char* draft;
+    size_t browse;
+    char* prompt;
+    History history;
+    struct Completion completion;
+    struct termios modes;
+};
+
+typedef struct LineEditor* LineEditor;
+
+Exception line_editor(LineEditor instance, int descriptor, History history);
+ssize_t line_editor_read(LineEditor instance, String prompt, String* result);
+void finalize_line_editor(LineEditor instance);
+
+#endif
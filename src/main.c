@@ -3,14 +3,17 @@
 // Licensed under the MIT license.
 
 // References:
-//  - https://www.man7.org/linux/man-pages/man3/basename.3.html
 //  - https://www.man7.org/linux/man-pages/man3/fgets.3p.html
-//  - https://www.man7.org/linux/man-pages/man3/getcwd.3.html
+//  - https://www.man7.org/linux/man-pages/man3/isatty.3.html
 //  - https://www.man7.org/linux/man-pages/man3/getline.3.html
+//  - https://www.man7.org/linux/man-pages/man2/mmap.2.html
+//  - https://www.man7.org/linux/man-pages/man3/posix_madvise.3.html
+//  - https://www.man7.org/linux/man-pages/man2/sigaction.2.html
 //  - https://www.man7.org/linux/man-pages/man2/signal.2.html
 
-#include <errno.h>
-#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <string.h>
@@ -18,70 +21,408 @@
 #include "argument_vector.h"
 #include "euler.h"
 #include "handler.h"
+#include "lexer.h"
+#include "line_editor.h"
 #include "parser.h"
+#include "trace.h"
+#define MAIN_HISTORY_FILE_NAME "/.nyush_history"
+#define MAIN_TRACE "NYUSH_TRACE"
+#define MAIN_CONTINUATION_PROMPT "> "
 
-int main()
+struct Continuation
 {
-    signal(SIGINT, SIG_IGN);
-    signal(SIGQUIT, SIG_IGN);
-    signal(SIGTSTP, SIG_IGN);
+    size_t length;
+    size_t capacity;
+    char* buffer;
+    struct LexerContinuation lexer;
+};
 
-    struct Parser state;
+typedef struct Continuation* Continuation;
 
-    euler_ok(parser(&state));
+static void main_notify(JobCollection jobs)
+{
+    for (size_t i = 0; i < jobs->end; i++)
+    {
+        Job item = jobs->items + i;
 
-    size_t lineCapacity = 4;
-    String line = malloc(lineCapacity);
-    
-    euler_assert(line);
+        if (!item->text || item->state != JOB_STATE_DONE)
+        {
+            continue;
+        }
+
+        printf("[%zu] Done %s\n", i + 1, item->text);
+        euler_ok(job_collection_remove(jobs, i + 1));
+    }
+}
+
+// A loop may already have reaped a job that finished in the background, so
+// the notices are checked before each prompt either way.
+
+static void main_reap(JobCollection jobs)
+{
+    if (job_collection_changed())
+    {
+        job_collection_reap(jobs);
+    }
+
+    main_notify(jobs);
+}
+
+static void main_continue(
+    Continuation instance,
+    String line,
+    size_t length)
+{
+    size_t newLength = instance->length + length + 1;
+
+    if (newLength > instance->capacity)
+    {
+        size_t newCapacity = instance->capacity * 2;
+
+        if (newCapacity < newLength)
+        {
+            newCapacity = newLength;
+        }
+
+        String newBuffer = realloc(instance->buffer, newCapacity);
+
+        euler_assert(newBuffer);
+
+        instance->capacity = newCapacity;
+        instance->buffer = newBuffer;
+    }
+
+    if (instance->length)
+    {
+        instance->buffer[instance->length] = '\n';
+        instance->length++;
+    }
+
+    memcpy(instance->buffer + instance->length, line, length);
+
+    instance->length += length;
+}
+
+static void main_add_history(Parser state)
+{
+    size_t length = strlen(state->text);
+    String text = arena_copy(&state->arena, state->text, length);
+
+    euler_assert(text);
+
+    for (String p = text; (p = strchr(p, '\n')); p++)
+    {
+        *p = ';';
+    }
+
+    euler_ok(history_add(&state->history, text, length));
+}
+
+static bool main_execute(
+    Parser state,
+    Continuation continuation,
+    String line,
+    size_t length,
+    bool interactive)
+{
+    main_reap(&state->jobs);
+
+    while (length && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+    {
+        length--;
+    }
+
+    bool complete;
+
+    // Parsing the accumulated text after every line would take quadratic
+    // time, so a line that cannot close the open commands is only scanned.
+
+    if (continuation->length)
+    {
+        size_t start = continuation->length + 1;
+
+        main_continue(continuation, line, length);
+        euler_ok(lexer_continuation_add(
+            &continuation->lexer,
+            continuation->buffer,
+            start,
+            length,
+            &complete));
+
+        if (!complete)
+        {
+            return true;
+        }
+
+        line = continuation->buffer;
+        length = continuation->length;
+    }
+
+    euler_ok(parser_parse(state, line, length));
+
+    if (state->incomplete)
+    {
+        if (!continuation->length)
+        {
+            main_continue(continuation, line, length);
+            lexer_continuation_clear(&continuation->lexer);
+            euler_ok(lexer_continuation_add(
+                &continuation->lexer,
+                continuation->buffer,
+                0,
+                length,
+                &complete));
+        }
+
+        return true;
+    }
+
+    continuation->length = 0;
+
+    if (interactive && state->text)
+    {
+        main_add_history(state);
+    }
+
+    if (state->faulted)
+    {
+        fprintf(stderr, "Error: invalid command\n");
+
+        state->status = 2;
+
+        return true;
+    }
+
+    return !state->root || parser_execute(state, state->root);
+}
+
+static void main_finish(Parser state, Continuation continuation)
+{
+    if (continuation->length)
+    {
+        fprintf(stderr, "Error: invalid command\n");
+
+        state->status = 2;
+    }
+
+    free(continuation->buffer);
+    finalize_lexer_continuation(&continuation->lexer);
+}
+
+static void main_execute_text(Parser state, String text, size_t length)
+{
+    struct Continuation continuation = { 0 };
+    String end = text + length;
+
+    while (text < end)
+    {
+        uint64_t start = trace_now();
+        String next = memchr(text, '\n', end - text);
+
+        if (!next)
+        {
+            next = end;
+        }
+
+        trace_event(TRACE_READ, start, next - text, 0, NULL);
+
+        if (!main_execute(state, &continuation, text, next - text, false))
+        {
+            break;
+        }
+
+        text = next + 1;
+    }
+
+    main_finish(state, &continuation);
+}
+
+static bool main_execute_file(Parser state, String path)
+{
+    int descriptor = open(path, O_CLOEXEC | O_RDONLY);
+
+    if (descriptor == -1)
+    {
+        return false;
+    }
+
+    struct stat status;
+
+    if (fstat(descriptor, &status) == -1 || !S_ISREG(status.st_mode))
+    {
+        close(descriptor);
+
+        return false;
+    }
+
+    size_t length = status.st_size;
+
+    if (!length)
+    {
+        close(descriptor);
+
+        return true;
+    }
+
+    String text = mmap(NULL, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    close(descriptor);
+
+    if (text == MAP_FAILED)
+    {
+        return false;
+    }
+
+    posix_madvise(text, length, POSIX_MADV_SEQUENTIAL);
+    main_execute_text(state, text, length);
+    munmap(text, length);
 
-    size_t currentDirectoryCapacity = 4;
-    String currentDirectory = malloc(currentDirectoryCapacity);
+    return true;
+}
 
-    euler_assert(currentDirectory);
+static void main_load_history(History instance, VariableTable variables)
+{
+    String home = variable_table_get(variables, "HOME");
+
+    if (!home)
+    {
+        return;
+    }
+
+    size_t length = strlen(home) + sizeof MAIN_HISTORY_FILE_NAME;
+    String path = malloc(length);
+
+    euler_assert(path);
+    snprintf(path, length, "%s" MAIN_HISTORY_FILE_NAME, home);
+    euler_ok(history_load(instance, path));
+    free(path);
+}
+
+static void main_execute_terminal(Parser state)
+{
+    struct LineEditor editor;
+    struct Continuation continuation = { 0 };
+
+    euler_ok(line_editor(&editor, STDIN_FILENO, &state->history));
 
     for (;;)
     {
-        errno = 0;
-        
-        while (!getcwd(currentDirectory, currentDirectoryCapacity))
+        main_reap(&state->jobs);
+
+        String line;
+        String prompt = state->prompt;
+
+        if (continuation.length)
         {
-            euler_assert(errno == ERANGE);
+            prompt = MAIN_CONTINUATION_PROMPT;
+        }
 
-            currentDirectoryCapacity *= 2;
-            currentDirectory = realloc(
-                currentDirectory, 
-                currentDirectoryCapacity);
+        uint64_t start = trace_now();
+        ssize_t length = line_editor_read(&editor, prompt, &line);
 
-            euler_assert(currentDirectory);
+        trace_event(TRACE_READ, start, length, 0, NULL);
+
+        if (length == -1 ||
+            !main_execute(state, &continuation, line, length, true))
+        {
+            break;
         }
+    }
+
+    main_finish(state, &continuation);
+    finalize_line_editor(&editor);
+}
 
-        printf("[nyush %s]$ ", basename(currentDirectory));
-        fflush(stdout);
+static void main_execute_stream(Parser state)
+{
+    struct Continuation continuation = { 0 };
+    size_t lineCapacity = 4;
+    String line = malloc(lineCapacity);
 
+    euler_assert(line);
+
+    for (;;)
+    {
+        uint64_t start = trace_now();
         ssize_t length = getline(&line, &lineCapacity, stdin);
 
-        if (length == -1)
+        trace_event(TRACE_READ, start, length, 0, NULL);
+
+        if (length == -1 ||
+            !main_execute(state, &continuation, line, length, false))
         {
             break;
         }
+    }
+
+    main_finish(state, &continuation);
+    free(line);
+}
+
+int main(int count, String arguments[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGTSTP, SIG_IGN);
+
+    struct sigaction childAction = { 0 };
 
-        parser_parse(&state, line, length);
+    childAction.sa_handler = job_collection_on_child;
+    childAction.sa_flags = SA_RESTART;
 
-        if (state.faulted)
+    sigemptyset(&childAction.sa_mask);
+    euler_assert(sigaction(SIGCHLD, &childAction, NULL) != -1);
+
+    struct Parser state;
+
+    euler_ok(parser(&state));
+
+    String tracePath = variable_table_get(&state.variables, MAIN_TRACE);
+
+    if (tracePath && *tracePath && !trace_open(tracePath))
+    {
+        fprintf(stderr, "Error: invalid file\n");
+    }
+
+    if (count > 1 && strcmp(arguments[1], "-c") == 0)
+    {
+        if (count < 3)
         {
             fprintf(stderr, "Error: invalid command\n");
+            finalize_parser(&state);
 
-            continue;
+            return 2;
         }
-        
-        if (state.first && !state.first->execute(&state.jobs, state.first))
+
+        main_execute_text(&state, arguments[2], strlen(arguments[2]));
+    }
+    else if (count > 1)
+    {
+        if (!main_execute_file(&state, arguments[1]))
         {
-            break;
+            fprintf(stderr, "Error: invalid file\n");
+            finalize_parser(&state);
+
+            return 127;
         }
     }
+    else if (isatty(STDIN_FILENO))
+    {
+        signal(SIGINT, SIG_IGN);
+        signal(SIGTTIN, SIG_IGN);
+        signal(SIGTTOU, SIG_IGN);
+        job_collection_control_terminal(&state.jobs, STDIN_FILENO);
+        main_load_history(&state.history, &state.variables);
+        main_execute_terminal(&state);
+    }
+    else
+    {
+        main_execute_stream(&state);
+    }
+
+    int status = state.status;
 
-    free(line);
-    free(currentDirectory);
     finalize_parser(&state);
+
+    return status;
 }
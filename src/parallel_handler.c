@@ -0,0 +1,848 @@
+// parallel_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.gnu.org/software/parallel/parallel.html
+//  - https://www.man7.org/linux/man-pages/man2/signalfd.2.html
+//  - https://www.man7.org/linux/man-pages/man2/poll.2.html
+//  - https://www.man7.org/linux/man-pages/man2/pipe.2.html
+//  - https://www.man7.org/linux/man-pages/man2/sigprocmask.2.html
+//  - https://www.gnu.org/software/libc/manual/html_node/Stopping-and-Starting-Jobs.html
+
+#define _GNU_SOURCE
+#include <sys/signalfd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "handler.h"
+#include "stream.h"
+#define PARALLEL_HANDLER_BUFFER 65536
+#define PARALLEL_HANDLER_MAX_FAILURES 101
+#define PARALLEL_HANDLER_PLACEHOLDER "{}"
+#define PARALLEL_HANDLER_SEPARATOR ":::"
+
+struct ParallelTask
+{
+    String argument;
+    pid_t pid;
+    int descriptor;
+    bool exited;
+    size_t length;
+    size_t capacity;
+    char* buffer;
+};
+
+// A pool is registered as one job whose members are its tasks, so `jobs -l`
+// lists every command it has started along with its exit status. The pool
+// outlives the command line that started it when Ctrl-Z suspends it, until
+// `fg` resumes it.
+
+struct Parallel
+{
+    Parser state;
+    int input;
+    int output;
+    size_t width;
+    String* words;
+    size_t count;
+    struct ParallelTask* tasks;
+    struct pollfd* events;
+    size_t* owners;
+    size_t limit;
+    size_t started;
+    size_t finished;
+    size_t running;
+    size_t id;
+    pid_t group;
+    int failures;
+    bool interrupted;
+    bool suspended;
+    String lines;
+    struct Arena arena;
+    struct Parallel* next;
+};
+
+typedef struct ParallelTask* ParallelTask;
+typedef struct Parallel* Parallel;
+
+static bool parallel_handler_parse_jobs(String value, size_t* result)
+{
+    char* end;
+    long jobs = strtol(value, &end, 10);
+
+    if (!*value || *end || jobs < 1)
+    {
+        return false;
+    }
+
+    *result = jobs;
+
+    return true;
+}
+
+static String parallel_handler_read(int input, size_t* count)
+{
+    size_t length = 0;
+    size_t capacity = PARALLEL_HANDLER_BUFFER;
+    String result = malloc(capacity + 1);
+
+    euler_assert(result);
+
+    for (;;)
+    {
+        if (length == capacity)
+        {
+            capacity *= 2;
+            result = realloc(result, capacity + 1);
+
+            euler_assert(result);
+        }
+
+        ssize_t received = read(input, result + length, capacity - length);
+
+        if (received == -1 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (received <= 0)
+        {
+            break;
+        }
+
+        length += received;
+    }
+
+    if (length && result[length - 1] != '\n')
+    {
+        result[length] = '\n';
+        length++;
+    }
+
+    *count = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (result[i] == '\n')
+        {
+            result[i] = '\0';
+            (*count)++;
+        }
+    }
+
+    return result;
+}
+
+// Substitutes the input for every occurrence of the placeholder in a word,
+// so that an argument like "echo {}" receives it too.
+
+static String parallel_handler_replace(
+    Parser state,
+    String word,
+    String argument)
+{
+    size_t placeholderLength = strlen(PARALLEL_HANDLER_PLACEHOLDER);
+    size_t argumentLength = strlen(argument);
+    size_t occurrences = 0;
+
+    for (String p = word;
+        (p = strstr(p, PARALLEL_HANDLER_PLACEHOLDER));
+        p += placeholderLength)
+    {
+        occurrences++;
+    }
+
+    if (!occurrences)
+    {
+        return word;
+    }
+
+    size_t length = strlen(word) - occurrences * placeholderLength +
+        occurrences * argumentLength;
+    String result = arena_allocate(&state->arena, length + 1);
+    String destination = result;
+
+    euler_assert(result);
+
+    for (String p = word; *p;)
+    {
+        if (strncmp(p, PARALLEL_HANDLER_PLACEHOLDER, placeholderLength) == 0)
+        {
+            memcpy(destination, argument, argumentLength);
+
+            destination += argumentLength;
+            p += placeholderLength;
+
+            continue;
+        }
+
+        *destination = *p;
+        destination++;
+        p++;
+    }
+
+    *destination = '\0';
+
+    return result;
+}
+
+static Job parallel_handler_job(Parallel instance)
+{
+    return job_collection_get(&instance->state->jobs, instance->id);
+}
+
+static void parallel_handler_start(Parallel instance, ParallelTask task)
+{
+    Parser state = instance->state;
+    Instruction current = arena_allocate_zero(
+        &state->arena,
+        sizeof * current);
+    String* arguments = arena_allocate(
+        &state->arena,
+        (instance->width + 2) * sizeof * arguments);
+    size_t length = 0;
+    bool placed = false;
+
+    euler_assert(current);
+    euler_assert(arguments);
+
+    for (size_t i = 0; i < instance->width; i++)
+    {
+        arguments[length] = parallel_handler_replace(
+            state,
+            instance->words[i],
+            task->argument);
+
+        if (arguments[length] != instance->words[i])
+        {
+            placed = true;
+        }
+
+        length++;
+    }
+
+    if (!placed)
+    {
+        arguments[length] = task->argument;
+        length++;
+    }
+
+    arguments[length] = NULL;
+    current->type = INSTRUCTION_COMMAND;
+    current->arguments = arguments;
+    current->length = length;
+
+    int descriptors[EXECUTE_HANDLER_DESCRIPTORS];
+    int pipes[2];
+
+    for (int i = 0; i < EXECUTE_HANDLER_DESCRIPTORS; i++)
+    {
+        descriptors[i] = i;
+    }
+
+    euler_assert(pipe2(pipes, O_CLOEXEC) != -1);
+
+    descriptors[STDIN_FILENO] = instance->input;
+    descriptors[STDOUT_FILENO] = pipes[1];
+
+    pid_t pid = execute_handler_run(
+        state,
+        current,
+        descriptors,
+        instance->group,
+        pipes[0]);
+
+    euler_assert(close(pipes[1]) != -1);
+
+    task->descriptor = pipes[0];
+
+    size_t member = task - instance->tasks;
+
+    if (pid <= 0)
+    {
+        Job item = parallel_handler_job(instance);
+
+        item->statuses[member] = JOB_STATUS_NOT_FOUND;
+        item->running--;
+        task->exited = true;
+        instance->failures++;
+
+        return;
+    }
+
+    euler_ok(job_collection_attach(
+        &state->jobs,
+        instance->id,
+        member,
+        pid));
+
+    task->pid = pid;
+    instance->running++;
+}
+
+static void parallel_handler_drain(Parallel instance, ParallelTask task)
+{
+    char buffer[PARALLEL_HANDLER_BUFFER];
+    ssize_t length = read(task->descriptor, buffer, sizeof buffer);
+
+    if (length == -1 && errno == EINTR)
+    {
+        return;
+    }
+
+    if (length <= 0)
+    {
+        euler_assert(close(task->descriptor) != -1);
+
+        task->descriptor = -1;
+
+        return;
+    }
+
+    // The oldest unfinished task writes straight through. Later tasks are
+    // held back until every task before them has been written.
+
+    if (task == instance->tasks + instance->finished)
+    {
+        stream_write(instance->output, buffer, length);
+
+        return;
+    }
+
+    if (task->length + length > task->capacity)
+    {
+        size_t newCapacity = task->capacity * 2;
+
+        if (newCapacity < task->length + length)
+        {
+            newCapacity = task->length + length;
+        }
+
+        char* newBuffer = realloc(task->buffer, newCapacity);
+
+        euler_assert(newBuffer);
+
+        task->capacity = newCapacity;
+        task->buffer = newBuffer;
+    }
+
+    memcpy(task->buffer + task->length, buffer, length);
+
+    task->length += length;
+}
+
+static void parallel_handler_reap(Parallel instance)
+{
+    job_collection_reap(&instance->state->jobs);
+
+    Job item = parallel_handler_job(instance);
+
+    for (size_t i = instance->finished; i < instance->started; i++)
+    {
+        ParallelTask task = instance->tasks + i;
+
+        if (task->exited || item->statuses[i] == -1)
+        {
+            continue;
+        }
+
+        if (job_status_code(item->statuses[i]))
+        {
+            instance->failures++;
+        }
+
+        task->exited = true;
+        instance->running--;
+    }
+}
+
+// Each task leads its own process group, except in a forked copy of the
+// shell, where the tasks stay in the copy's group so that signals sent to
+// the job as a whole reach them.
+
+static void parallel_handler_signal(Parallel instance, int signal)
+{
+    for (size_t i = instance->finished; i < instance->started; i++)
+    {
+        ParallelTask task = instance->tasks + i;
+
+        if (!task->pid || task->exited)
+        {
+            continue;
+        }
+
+        if (instance->group)
+        {
+            kill(task->pid, signal);
+        }
+        else
+        {
+            killpg(task->pid, signal);
+        }
+    }
+}
+
+static void parallel_handler_flush(Parallel instance)
+{
+    while (instance->finished < instance->started)
+    {
+        ParallelTask task = instance->tasks + instance->finished;
+
+        stream_write(instance->output, task->buffer, task->length);
+        free(task->buffer);
+
+        task->buffer = NULL;
+        task->length = 0;
+        task->capacity = 0;
+
+        if (!task->exited || task->descriptor != -1)
+        {
+            return;
+        }
+
+        instance->finished++;
+    }
+}
+
+static void parallel_handler_run(Parallel instance)
+{
+    sigset_t mask;
+    sigset_t previous;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGINT);
+
+    if (instance->state->jobs.terminal != -1)
+    {
+        sigaddset(&mask, SIGTSTP);
+    }
+
+    euler_assert(sigprocmask(SIG_BLOCK, &mask, &previous) != -1);
+
+    int signals = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    struct pollfd* events = instance->events;
+    size_t* owners = instance->owners;
+    bool changed = false;
+
+    euler_assert(signals != -1);
+
+    // Tasks may have finished while the pool was suspended.
+
+    parallel_handler_reap(instance);
+
+    for (;;)
+    {
+        while (!instance->interrupted &&
+            instance->started < instance->count &&
+            instance->running < instance->limit)
+        {
+            parallel_handler_start(
+                instance,
+                instance->tasks + instance->started);
+
+            instance->started++;
+        }
+
+        parallel_handler_flush(instance);
+
+        if (instance->finished == instance->started &&
+            (instance->interrupted || instance->started == instance->count))
+        {
+            break;
+        }
+
+        size_t count = 1;
+
+        events[0].fd = signals;
+        events[0].events = POLLIN;
+
+        for (size_t i = instance->finished; i < instance->started; i++)
+        {
+            if (instance->tasks[i].descriptor == -1)
+            {
+                continue;
+            }
+
+            events[count].fd = instance->tasks[i].descriptor;
+            events[count].events = POLLIN;
+            owners[count - 1] = i;
+            count++;
+        }
+
+        if (poll(events, count, -1) == -1)
+        {
+            euler_assert(errno == EINTR);
+
+            continue;
+        }
+
+        for (size_t i = 1; i < count; i++)
+        {
+            if (events[i].revents)
+            {
+                parallel_handler_drain(
+                    instance,
+                    instance->tasks + owners[i - 1]);
+            }
+        }
+
+        if (!events[0].revents)
+        {
+            continue;
+        }
+
+        struct signalfd_siginfo info;
+
+        while (read(signals, &info, sizeof info) == sizeof info)
+        {
+            if (info.ssi_signo == SIGINT && !instance->interrupted)
+            {
+                instance->interrupted = true;
+
+                parallel_handler_signal(instance, SIGINT);
+            }
+            else if (info.ssi_signo == SIGTSTP)
+            {
+                instance->suspended = true;
+            }
+            else if (info.ssi_signo == SIGCHLD)
+            {
+                changed = true;
+            }
+        }
+
+        parallel_handler_reap(instance);
+
+        if (instance->suspended)
+        {
+            parallel_handler_signal(instance, SIGTSTP);
+
+            parallel_handler_job(instance)->state = JOB_STATE_STOPPED;
+
+            break;
+        }
+    }
+
+    euler_assert(close(signals) != -1);
+    euler_assert(sigprocmask(SIG_SETMASK, &previous, NULL) != -1);
+
+    // The pool consumed the SIGCHLD that would have told the shell about
+    // other jobs finishing in the meantime.
+
+    if (changed)
+    {
+        raise(SIGCHLD);
+    }
+}
+
+static void parallel_handler_free(Parallel instance)
+{
+    for (size_t i = instance->finished; i < instance->count; i++)
+    {
+        if (instance->tasks[i].descriptor != -1)
+        {
+            close(instance->tasks[i].descriptor);
+        }
+
+        free(instance->tasks[i].buffer);
+    }
+
+    close(instance->input);
+    close(instance->output);
+    free(instance->lines);
+    finalize_arena(&instance->arena);
+    free(instance);
+}
+
+// Runs the pool until it finishes or is suspended. A finished pool leaves
+// the job table and returns its status; a suspended one stays listed as a
+// stopped job.
+
+static int parallel_handler_continue(Parallel instance)
+{
+    Parser state = instance->state;
+
+    instance->suspended = false;
+
+    parallel_handler_run(instance);
+
+    if (instance->suspended)
+    {
+        return 128 + SIGTSTP;
+    }
+
+    Parallel* p = &state->pools;
+
+    while (*p != instance)
+    {
+        p = &(*p)->next;
+    }
+
+    *p = instance->next;
+
+    euler_ok(job_collection_remove(&state->jobs, instance->id));
+
+    int result = instance->failures;
+
+    if (instance->interrupted)
+    {
+        result = 128 + SIGINT;
+    }
+    else if (result > PARALLEL_HANDLER_MAX_FAILURES)
+    {
+        result = PARALLEL_HANDLER_MAX_FAILURES;
+    }
+
+    parallel_handler_free(instance);
+
+    return result;
+}
+
+static Parallel parallel_handler_find(Parser state, size_t id)
+{
+    for (Parallel p = state->pools; p; p = p->next)
+    {
+        if (p->id == id)
+        {
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+static void parallel_handler_register(Parallel instance, Instruction value)
+{
+    Parser state = instance->state;
+    size_t count = instance->count;
+    size_t textLength = 0;
+
+    for (size_t i = 0; i < value->length; i++)
+    {
+        textLength += strlen(value->arguments[i]) + 1;
+    }
+
+    String text = arena_allocate(&state->arena, textLength);
+    pid_t* pids = arena_allocate_zero(&state->arena, count * sizeof * pids);
+    int* statuses = arena_allocate(&state->arena, count * sizeof * statuses);
+    struct rusage* usages = arena_allocate(
+        &state->arena,
+        count * sizeof * usages);
+    String p = text;
+
+    euler_assert(text);
+    euler_assert(pids || !count);
+    euler_assert(statuses || !count);
+    euler_assert(usages || !count);
+
+    for (size_t i = 0; i < value->length; i++)
+    {
+        size_t length = strlen(value->arguments[i]);
+
+        memcpy(p, value->arguments[i], length);
+
+        p += length;
+        *p = ' ';
+        p++;
+    }
+
+    p[-1] = '\0';
+
+    for (size_t i = 0; i < count; i++)
+    {
+        statuses[i] = -1;
+    }
+
+    struct Job item;
+
+    job(&item, text, pids, statuses, usages, count);
+
+    // Tasks that have not started, and the pool itself, keep the job running
+    // until the pool finishes, so the shell never reports it done early.
+
+    item.running = count + 1;
+    item.state = JOB_STATE_RUNNING;
+
+    euler_ok(job_collection_add(&state->jobs, &item, &instance->id));
+}
+
+bool parallel_handler_owns(Parser state, size_t id)
+{
+    return parallel_handler_find(state, id);
+}
+
+bool parallel_handler_resume(Parser state, size_t id)
+{
+    Parallel instance = parallel_handler_find(state, id);
+
+    if (!instance)
+    {
+        return false;
+    }
+
+    parallel_handler_job(instance)->state = JOB_STATE_RUNNING;
+
+    fflush(stdout);
+    parallel_handler_signal(instance, SIGCONT);
+
+    state->status = parallel_handler_continue(instance);
+
+    return true;
+}
+
+int parallel_handler(
+    Parser state,
+    Instruction instruction,
+    int input,
+    int output)
+{
+    String* arguments = instruction->arguments;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t jobs = processors > 0 ? processors : 1;
+    size_t start = 1;
+
+    if (start < instruction->length &&
+        strncmp(arguments[start], "-j", 2) == 0)
+    {
+        String value = arguments[start] + 2;
+
+        if (!*value && start + 1 < instruction->length)
+        {
+            start++;
+            value = arguments[start];
+        }
+
+        if (!parallel_handler_parse_jobs(value, &jobs))
+        {
+            fprintf(stderr, "Error: invalid number\n");
+
+            return 2;
+        }
+
+        start++;
+    }
+
+    size_t end = start;
+
+    while (end < instruction->length &&
+        strcmp(arguments[end], PARALLEL_HANDLER_SEPARATOR) != 0)
+    {
+        end++;
+    }
+
+    if (end == start)
+    {
+        fprintf(stderr, "Error: invalid command\n");
+
+        return 2;
+    }
+
+    Parallel pool = calloc(1, sizeof * pool);
+
+    euler_assert(pool);
+    arena(&pool->arena, 0);
+
+    pool->state = state;
+    pool->width = end - start;
+    pool->limit = jobs;
+    pool->words = arena_allocate(
+        &pool->arena,
+        pool->width * sizeof * pool->words);
+
+    euler_assert(pool->words);
+
+    for (size_t i = 0; i < pool->width; i++)
+    {
+        String word = arguments[start + i];
+
+        pool->words[i] = arena_copy(&pool->arena, word, strlen(word));
+
+        euler_assert(pool->words[i]);
+    }
+
+    if (end < instruction->length)
+    {
+        pool->count = instruction->length - end - 1;
+    }
+    else
+    {
+        pool->lines = parallel_handler_read(input, &pool->count);
+    }
+
+    pool->tasks = arena_allocate_zero(
+        &pool->arena,
+        (pool->count + 1) * sizeof * pool->tasks);
+    pool->events = arena_allocate(
+        &pool->arena,
+        (pool->count + 1) * sizeof * pool->events);
+    pool->owners = arena_allocate(
+        &pool->arena,
+        (pool->count + 1) * sizeof * pool->owners);
+
+    euler_assert(pool->tasks);
+    euler_assert(pool->events);
+    euler_assert(pool->owners);
+
+    String line = pool->lines;
+
+    for (size_t i = 0; i < pool->count; i++)
+    {
+        ParallelTask task = pool->tasks + i;
+
+        if (line)
+        {
+            task->argument = line;
+            line += strlen(line) + 1;
+        }
+        else
+        {
+            String argument = arguments[end + 1 + i];
+
+            task->argument = arena_copy(
+                &pool->arena,
+                argument,
+                strlen(argument));
+
+            euler_assert(task->argument);
+        }
+
+        task->descriptor = -1;
+    }
+
+    if (state->jobs.subshell)
+    {
+        pool->group = -1;
+    }
+
+    pool->input = open("/dev/null", O_CLOEXEC | O_RDONLY);
+    pool->output = fcntl(output, F_DUPFD_CLOEXEC, 0);
+
+    euler_assert(pool->input != -1);
+    euler_assert(pool->output != -1);
+    parallel_handler_register(pool, instruction);
+
+    pool->next = state->pools;
+    state->pools = pool;
+
+    fflush(stdout);
+
+    return parallel_handler_continue(pool);
+}
+
+void finalize_parallel_handler(Parser state)
+{
+    while (state->pools)
+    {
+        Parallel next = state->pools->next;
+
+        parallel_handler_free(state->pools);
+
+        state->pools = next;
+    }
+}
@@ -0,0 +1,219 @@
+// parse_cache.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://en.wikipedia.org/wiki/Cache_replacement_policies
+//  - https://arxiv.org/abs/1512.00727
+//  - https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+
+#include <stdlib.h>
+#include <string.h>
+#include "parse_cache.h"
+
+// A capacity of zero disables the cache: every lookup misses and nothing is
+// admitted.
+
+Exception parse_cache(ParseCache instance, size_t capacity)
+{
+    if (capacity && capacity < 4)
+    {
+        capacity = 4;
+    }
+
+    size_t bucketCount = 8;
+
+    while (bucketCount < capacity * 2)
+    {
+        bucketCount *= 2;
+    }
+
+    instance->buckets = calloc(bucketCount, sizeof * instance->buckets);
+
+    if (!instance->buckets)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->seen = calloc(bucketCount, sizeof * instance->seen);
+
+    if (!instance->seen)
+    {
+        free(instance->buckets);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->count = 0;
+    instance->capacity = capacity;
+    instance->bucketCount = bucketCount;
+    instance->newest = NULL;
+    instance->oldest = NULL;
+    instance->hits = 0;
+    instance->misses = 0;
+
+    return 0;
+}
+
+static size_t parse_cache_hash(String text, size_t length)
+{
+    size_t result = 14695981039346656037ull;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        result ^= (unsigned char)text[i];
+        result *= 1099511628211ull;
+    }
+
+    return result;
+}
+
+static void parse_cache_unlink(ParseCache instance, ParseCacheEntry entry)
+{
+    if (entry->newer)
+    {
+        entry->newer->older = entry->older;
+    }
+    else
+    {
+        instance->newest = entry->older;
+    }
+
+    if (entry->older)
+    {
+        entry->older->newer = entry->newer;
+    }
+    else
+    {
+        instance->oldest = entry->newer;
+    }
+}
+
+static void parse_cache_push(ParseCache instance, ParseCacheEntry entry)
+{
+    entry->newer = NULL;
+    entry->older = instance->newest;
+
+    if (instance->newest)
+    {
+        instance->newest->newer = entry;
+    }
+    else
+    {
+        instance->oldest = entry;
+    }
+
+    instance->newest = entry;
+}
+
+ParseCacheEntry parse_cache_find(
+    ParseCache instance,
+    String text,
+    size_t length,
+    bool* admit)
+{
+    size_t hash = parse_cache_hash(text, length);
+    size_t index = hash & (instance->bucketCount - 1);
+    ParseCacheEntry entry = instance->buckets[index];
+
+    while (entry &&
+        (entry->hash != hash ||
+            entry->length != length ||
+            memcmp(entry->text, text, length) != 0))
+    {
+        entry = entry->next;
+    }
+
+    if (!entry)
+    {
+        *admit = instance->capacity && instance->seen[index] == hash;
+        instance->seen[index] = hash;
+        instance->misses++;
+
+        return NULL;
+    }
+
+    instance->hits++;
+
+    if (instance->newest != entry)
+    {
+        parse_cache_unlink(instance, entry);
+        parse_cache_push(instance, entry);
+    }
+
+    return entry;
+}
+
+static void parse_cache_evict(ParseCache instance)
+{
+    ParseCacheEntry entry = instance->oldest;
+    ParseCacheEntry* link = instance->buckets +
+        (entry->hash & (instance->bucketCount - 1));
+
+    while (*link != entry)
+    {
+        link = &(*link)->next;
+    }
+
+    *link = entry->next;
+
+    parse_cache_unlink(instance, entry);
+    finalize_arena(&entry->arena);
+    free(entry);
+
+    instance->count--;
+}
+
+Exception parse_cache_add(
+    ParseCache instance,
+    String text,
+    size_t length,
+    Instruction root,
+    Arena arena)
+{
+    ParseCacheEntry entry = malloc(sizeof * entry);
+
+    if (!entry)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    if (instance->count == instance->capacity)
+    {
+        parse_cache_evict(instance);
+    }
+
+    size_t hash = parse_cache_hash(text, length);
+    ParseCacheEntry* bucket = instance->buckets +
+        (hash & (instance->bucketCount - 1));
+
+    entry->text = text;
+    entry->length = length;
+    entry->hash = hash;
+    entry->root = root;
+    entry->next = *bucket;
+    *bucket = entry;
+
+    arena_move(&entry->arena, arena);
+    parse_cache_push(instance, entry);
+
+    instance->count++;
+
+    return 0;
+}
+
+void finalize_parse_cache(ParseCache instance)
+{
+    while (instance->count)
+    {
+        parse_cache_evict(instance);
+    }
+
+    free(instance->buckets);
+    free(instance->seen);
+
+    instance->capacity = 0;
+    instance->bucketCount = 0;
+    instance->buckets = NULL;
+    instance->seen = NULL;
+}
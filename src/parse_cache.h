@@ -0,0 +1,61 @@
+// parse_cache.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://en.wikipedia.org/wiki/Cache_replacement_policies
+
+#ifndef PARSE_CACHE_2b8e4f1a6c9d4a3e9f7b0d5c1e8a2f6b
+#define PARSE_CACHE_2b8e4f1a6c9d4a3e9f7b0d5c1e8a2f6b
+#include <stdbool.h>
+#include <stddef.h>
+#include "arena.h"
+#include "euler.h"
+#include "job_collection.h"
+
+struct ParseCacheEntry
+{
+    char* text;
+    size_t length;
+    size_t hash;
+    struct Instruction* root;
+    struct Arena arena;
+    struct ParseCacheEntry* next;
+    struct ParseCacheEntry* newer;
+    struct ParseCacheEntry* older;
+};
+
+struct ParseCache
+{
+    size_t count;
+    size_t capacity;
+    size_t bucketCount;
+    struct ParseCacheEntry** buckets;
+    size_t* seen;
+    struct ParseCacheEntry* newest;
+    struct ParseCacheEntry* oldest;
+    size_t hits;
+    size_t misses;
+};
+
+typedef struct ParseCacheEntry* ParseCacheEntry;
+typedef struct ParseCache* ParseCache;
+
+Exception parse_cache(ParseCache instance, size_t capacity);
+
+ParseCacheEntry parse_cache_find(
+    ParseCache instance,
+    String text,
+    size_t length,
+    bool* admit);
+
+Exception parse_cache_add(
+    ParseCache instance,
+    String text,
+    size_t length,
+    Instruction root,
+    Arena arena);
+
+void finalize_parse_cache(ParseCache instance);
+
+#endif
@@ -3,65 +3,89 @@
 // Licensed under the MIT license.
 
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "euler.h"
+#include "expansion.h"
 #include "handler.h"
 #include "parser.h"
-
-char* INVALID_CHARS = "><*!`'\"|";
-String SYMBOL_STRINGS[SYMBOLS] =
+#include "trace.h"
+#define PARSER_HISTORY_CAPACITY 1000
+#define PARSER_CACHE_CAPACITY 64
+#define PARSER_WORKING_DIRECTORY "PWD"
+#define PARSER_PROMPT_FORMAT "[nyush %s]$ "
+
+extern char** environ;
+
+static Instruction parser_add(
+    Parser instance,
+    InstructionType type,
+    Handler handler)
 {
-    [SYMBOL_NONE] = NULL,
-    [SYMBOL_CHANGE_DIRECTORY] = "cd",
-    [SYMBOL_EXIT] = "exit",
-    [SYMBOL_FOREGROUND] = "fg",
-    [SYMBOL_JOBS] = "jobs",
-    [SYMBOL_READ] = "<",
-    [SYMBOL_WRITE] = ">",
-    [SYMBOL_APPEND] = ">>",
-    [SYMBOL_PIPE] = "|",
-    [SYMBOL_STRING] = NULL,
-    [SYMBOL_INVALID] = NULL
-};
+    Instruction result = arena_allocate_zero(&instance->arena, sizeof * result);
 
-static Instruction parser_add(Parser instance, Handler handler)
-{
-    Instruction result = calloc(1, sizeof * result);
+    euler_assert(result);
 
-    result->descriptors[0] = -1;
-    result->descriptors[1] = -1;
+    result->type = type;
     result->execute = handler;
 
-    if (instance->last)
+    return result;
+}
+
+static String parser_copy(Parser instance, Token token)
+{
+    String result = arena_copy(&instance->arena, token->value, token->length);
+
+    euler_assert(result);
+
+    return result;
+}
+
+static String parser_copy_text(Parser instance, size_t offset)
+{
+    if (offset + 2 > instance->index)
     {
-        instance->last->nextPipe = result;
-        instance->last = result;
+        return "";
     }
-    else
+
+    Token first = instance->lexer.items + offset;
+    Token last = instance->lexer.items + instance->index - 2;
+
+    if (last->symbol == SYMBOL_DOCUMENT)
     {
-        instance->first = result;
-        instance->last = result;
-        result->text = instance->text;
+        last--;
     }
+    String result = arena_copy(
+        &instance->arena,
+        first->value,
+        last->value + last->length - first->value);
+
+    euler_assert(result);
 
     return result;
 }
 
 static void parser_reset(Parser instance)
 {
+    parser_close_descriptors(instance, 0);
+    parser_wait_processes(instance, 0);
+
     instance->current = SYMBOL_NONE;
     instance->index = 0;
     instance->faulted = false;
+    instance->incomplete = false;
+    instance->substituted = false;
+    instance->text = NULL;
+    instance->root = NULL;
 
-    if (instance->first)
-    {
-        job_collection_free_instruction(&instance->jobs, instance->first);
-
-        instance->first = NULL;
-    }
-
-    instance->last = NULL;
+    directory_cache_clear(&instance->directories);
+    arena_reset(&instance->arena);
 }
 
 Exception parser(Parser instance)
@@ -73,60 +97,76 @@ Exception parser(Parser instance)
         return ex;
     }
 
-    ex = argument_vector(&instance->arguments, 0);
+    ex = command_table(&instance->commands, 0);
 
     if (ex)
     {
         return ex;
     }
 
-    instance->first = NULL;
-    instance->jobs.aliasReference = &instance->first;
-    instance->text = NULL;
+    ex = lexer(&instance->lexer, 0);
 
-    parser_reset(instance);
+    if (ex)
+    {
+        return ex;
+    }
 
-    return 0;
-}
+    ex = parse_cache(&instance->cache, PARSER_CACHE_CAPACITY);
 
-static Symbol parser_classify(String value)
-{
-    for (Symbol symbol = 0; symbol < SYMBOLS; symbol++)
+    if (ex)
     {
-        if (!SYMBOL_STRINGS[symbol])
-        {
-            continue;
-        }
+        return ex;
+    }
 
-        if (strcmp(value, SYMBOL_STRINGS[symbol]) == 0)
-        {
-            return symbol;
-        }
+    ex = variable_table(&instance->variables, 0);
+
+    if (ex)
+    {
+        return ex;
     }
 
-    for (char* p = INVALID_CHARS; *p; p++)
+    ex = variable_table_import(&instance->variables, environ);
+
+    if (ex)
     {
-        if (strchr(value, *p))
-        {
-            return SYMBOL_INVALID;
-        }
+        return ex;
     }
 
-    return SYMBOL_STRING;
+    instance->status = 0;
+    instance->id = getpid();
+    instance->pipeStatusCount = 0;
+    instance->pipeStatusCapacity = 0;
+    instance->pipeStatus = NULL;
+    instance->workingDirectoryCapacity = 0;
+    instance->workingDirectory = NULL;
+    instance->prompt = NULL;
+    instance->descriptorCount = 0;
+    instance->descriptorCapacity = 0;
+    instance->descriptors = NULL;
+    instance->processCount = 0;
+    instance->processCapacity = 0;
+    instance->processes = NULL;
+    instance->pools = NULL;
+
+    arena(&instance->arena, 0);
+    directory_cache(&instance->directories, &instance->arena);
+    history(&instance->history, PARSER_HISTORY_CAPACITY);
+    parser_reset(instance);
+
+    return parser_set_working_directory(instance);
 }
 
 static void parser_next(Parser instance)
 {
-    if (instance->index >= instance->arguments.count)
+    if (instance->index >= instance->lexer.count)
     {
         instance->current = SYMBOL_NONE;
+        instance->index = instance->lexer.count + 1;
 
         return;
     }
 
-    String token = instance->arguments.buffer[instance->index];
-
-    instance->current = parser_classify(token);
+    instance->current = instance->lexer.items[instance->index].symbol;
     instance->index++;
 }
 
@@ -150,230 +190,1341 @@ static void parser_expect(Parser instance, Symbol symbol)
     }
 
     instance->faulted = true;
-    
-    if (instance->first)
-    {
-        job_collection_free_instruction(&instance->jobs, instance->first);
+}
 
-        instance->first = NULL;
+static void parser_expect_keyword(Parser instance, Symbol symbol)
+{
+    if (!instance->faulted && instance->current == SYMBOL_NONE)
+    {
+        instance->incomplete = true;
     }
+
+    parser_expect(instance, symbol);
 }
 
-static void parser_parse_argument(Parser instance)
+static void parser_skip_separators(Parser instance)
 {
-    parser_expect(instance, SYMBOL_STRING);
+    while (instance->current == SYMBOL_SEMICOLON)
+    {
+        parser_next(instance);
+    }
 }
 
-static void parser_parse_command_name(Parser instance)
+static bool parser_is_word(Symbol symbol)
 {
-    parser_expect(instance, SYMBOL_STRING);
+    return symbol == SYMBOL_STRING ||
+        (symbol >= SYMBOL_CHANGE_DIRECTORY && symbol <= SYMBOL_DONE);
 }
 
-static void parser_parse_command_text(Parser instance)
+static bool parser_is_terminator(Symbol symbol)
 {
-    size_t offset = instance->index - 1;
-    size_t length = 1;
-
-    parser_parse_command_name(instance);
-
-    while (instance->current == SYMBOL_STRING)
+    switch (symbol)
     {
-        parser_parse_argument(instance);
+    case SYMBOL_NONE:
+    case SYMBOL_CLOSE:
+    case SYMBOL_THEN:
+    case SYMBOL_ELIF:
+    case SYMBOL_ELSE:
+    case SYMBOL_FI:
+    case SYMBOL_DO:
+    case SYMBOL_DONE:
+        return true;
 
-        length++;
+    default:
+        return false;
     }
+}
 
-    Instruction added = parser_add(instance, execute_handler);
+static bool parser_is_redirection(Symbol symbol)
+{
+    return symbol >= SYMBOL_READ && symbol <= SYMBOL_HERESTRING;
+}
 
-    added->length = length;
-    added->payload.arguments = instance->arguments.buffer + offset;
+static Token parser_token(Parser instance)
+{
+    return instance->lexer.items + instance->index - 1;
 }
 
-static void parser_parse_file_name(Parser instance)
+static Instruction parser_parse_list(Parser instance);
+
+// The text of a process substitution is compiled along with the enclosing
+// command so that each run only has to fork the prepared subshell.
+
+static Instruction parser_parse_nested(
+    Parser instance,
+    String value,
+    size_t length)
 {
-    parser_expect(instance, SYMBOL_STRING);
+    struct Lexer outer = instance->lexer;
+    size_t index = instance->index;
+    Symbol current = instance->current;
+    bool incomplete = instance->incomplete;
+    Instruction result = parser_add(instance, INSTRUCTION_SUBSHELL, NULL);
+
+    euler_ok(lexer(&instance->lexer, 0));
+    euler_ok(lexer_tokenize(&instance->lexer, value, length));
+
+    instance->index = 0;
+
+    parser_next(instance);
+
+    result->left = parser_parse_list(instance);
+
+    parser_expect(instance, SYMBOL_NONE);
+    finalize_lexer(&instance->lexer);
+
+    instance->lexer = outer;
+    instance->index = index;
+    instance->current = current;
+    instance->incomplete = incomplete;
+
+    return result;
 }
 
-static void parser_parse_terminate(Parser instance)
+static void parser_add_substitution(
+    Parser instance,
+    Instruction target,
+    String word,
+    size_t length,
+    Instruction value)
 {
-    if (parser_accept(instance, SYMBOL_WRITE))
-    {
-        size_t offset = instance->index - 1;
+    Substitution added = arena_allocate_zero(
+        &instance->arena,
+        sizeof * added);
+
+    euler_assert(added);
 
-        parser_parse_file_name(instance);
+    added->type = SUBSTITUTION_COMMAND;
+    added->word = word;
+    added->length = length;
+    added->next = target->substitutions;
+    target->substitutions = added;
 
-        instance->last->write = instance->arguments.buffer[offset];
+    if (value->left &&
+        value->left->type == INSTRUCTION_PIPELINE &&
+        !value->left->background)
+    {
+        added->instruction = value->left;
 
         return;
     }
 
-    if (parser_accept(instance, SYMBOL_APPEND))
-    {
-        size_t offset = instance->index - 1;
-        
-        parser_parse_file_name(instance);
+    // Anything other than a single foreground pipeline runs in a subshell, so
+    // that cd, exit, and assignments cannot leak into the shell itself.
 
-        instance->last->append = instance->arguments.buffer[offset];
+    Instruction pipeline = parser_add(
+        instance,
+        INSTRUCTION_PIPELINE,
+        execute_handler);
 
-        return;
-    }
+    pipeline->stageCount = 1;
+    pipeline->stages = arena_allocate(
+        &instance->arena,
+        sizeof * pipeline->stages);
+    pipeline->text = arena_copy(&instance->arena, word, length);
 
-    parser_expect(instance, SYMBOL_NONE);
+    euler_assert(pipeline->stages);
+    euler_assert(pipeline->text);
+
+    pipeline->stages[0] = value;
+    added->instruction = pipeline;
 }
 
-static void parser_parse_recursive(Parser instance)
+static String parser_unescape_backquoted(
+    Parser instance,
+    String value,
+    size_t length)
 {
-    parser_expect(instance, SYMBOL_PIPE);
-    parser_parse_command_text(instance);
+    String result = arena_allocate(&instance->arena, length + 1);
+    String write = result;
 
-    if (instance->current == SYMBOL_PIPE)
+    euler_assert(result);
+
+    for (String read = value; read < value + length; read++)
     {
-        parser_parse_recursive(instance);
+        if (*read == '\\' && read + 1 < value + length &&
+            strchr("$\\`", read[1]))
+        {
+            read++;
+        }
+
+        *write = *read;
+        write++;
     }
-    else
+
+    *write = '\0';
+
+    return result;
+}
+
+// Command substitutions are compiled along with the word that contains them
+// and keyed by the address of their `$` or backquote in that word. A
+// here-document body is scanned without regard to quotes.
+
+static void parser_parse_commands(
+    Parser instance,
+    Instruction target,
+    String word,
+    bool document)
+{
+    String end = word + strlen(word);
+    bool quoted = false;
+    String p = word;
+
+    while (p < end)
     {
-        parser_parse_terminate(instance);
-    }
+        String start = p;
+        String text;
+        size_t length;
 
-    parser_expect(instance, SYMBOL_NONE);
+        if (*p == '\\')
+        {
+            p += 1 + (p + 1 < end);
+
+            continue;
+        }
+
+        if (*p == '\'' && !document && !quoted)
+        {
+            String close = strchr(p + 1, '\'');
+
+            p = close ? close + 1 : end;
+
+            continue;
+        }
+
+        if (*p == '"' && !document)
+        {
+            quoted = !quoted;
+            p++;
+
+            continue;
+        }
+
+        if (*p == '$' && p[1] == '(')
+        {
+            length = lexer_measure_substitution(p + 1, end - p - 1);
+
+            if (!length)
+            {
+                p++;
+
+                continue;
+            }
+
+            text = p + 2;
+            length -= 2;
+            p += length + 3;
+        }
+        else if (*p == '`')
+        {
+            String close = p + 1;
+
+            while (close < end && *close != '`')
+            {
+                close += 1 + (*close == '\\' && close + 1 < end);
+            }
+
+            if (close >= end)
+            {
+                p++;
+
+                continue;
+            }
+
+            text = parser_unescape_backquoted(
+                instance,
+                p + 1,
+                close - p - 1);
+            length = strlen(text);
+            p = close + 1;
+        }
+        else
+        {
+            p++;
+
+            continue;
+        }
+
+        parser_add_substitution(
+            instance,
+            target,
+            start,
+            p - start,
+            parser_parse_nested(instance, text, length));
+    }
 }
 
-static void parser_parse_command(Parser instance)
+static String parser_copy_word(
+    Parser instance,
+    Instruction target,
+    Token token)
 {
-    if (parser_accept(instance, SYMBOL_NONE))
+    String result = parser_copy(instance, token);
+
+    if ((result[0] != '<' && result[0] != '>') || result[1] != '(')
     {
-        return;
+        if (strpbrk(result, "$`"))
+        {
+            parser_parse_commands(instance, target, result, false);
+        }
+
+        return result;
     }
 
-    if (parser_accept(instance, SYMBOL_CHANGE_DIRECTORY))
+    Substitution added = arena_allocate_zero(
+        &instance->arena,
+        sizeof * added);
+
+    euler_assert(added);
+
+    added->type = SUBSTITUTION_OUTPUT;
+
+    if (result[0] == '<')
     {
-        parser_parse_argument(instance);
-        parser_expect(instance, SYMBOL_NONE);
+        added->type = SUBSTITUTION_INPUT;
+    }
 
-        Instruction added = parser_add(instance, change_directory_handler);
+    added->word = result;
+    added->instruction = parser_parse_nested(
+        instance,
+        result + 2,
+        token->length - 3);
+    added->next = target->substitutions;
+    target->substitutions = added;
 
-        added->payload.argument = instance->arguments.buffer[1];
+    return result;
+}
 
-        return;
+static bool parser_is_quoted(Token token)
+{
+    for (size_t i = 0; i < token->length; i++)
+    {
+        if (strchr("'\"\\", token->value[i]))
+        {
+            return true;
+        }
     }
 
-    if (parser_accept(instance, SYMBOL_EXIT))
+    return false;
+}
+
+static void parser_parse_document(
+    Parser instance,
+    Instruction instruction,
+    Redirection target,
+    Token delimiter,
+    bool strip)
+{
+    Token token = parser_token(instance);
+
+    if (instance->current != SYMBOL_DOCUMENT || !token->value)
     {
-        parser_expect(instance, SYMBOL_NONE);
-        parser_add(instance, exit_handler);
+        if (!instance->faulted && instance->current == SYMBOL_DOCUMENT)
+        {
+            instance->incomplete = true;
+        }
+
+        instance->faulted = true;
 
         return;
     }
 
-    if (parser_accept(instance, SYMBOL_JOBS))
+    String result = parser_copy(instance, token);
+
+    if (strip)
     {
-        parser_expect(instance, SYMBOL_NONE);
-        parser_add(instance, jobs_handler);
-        
-        return;
+        String write = result;
+        bool start = true;
+
+        for (String read = result; *read; read++)
+        {
+            if (start && *read == '\t')
+            {
+                continue;
+            }
+
+            start = *read == '\n';
+            *write = *read;
+            write++;
+        }
+
+        *write = '\0';
     }
 
-    if (parser_accept(instance, SYMBOL_FOREGROUND))
-    {
-        parser_parse_argument(instance);
-        parser_expect(instance, SYMBOL_NONE);
-        
-        Instruction added = parser_add(instance, foreground_handler);
+    parser_next(instance);
 
-        added->payload.argument = instance->arguments.buffer[1];
+    if (parser_is_quoted(delimiter))
+    {
+        target->target = result;
 
         return;
     }
 
-    parser_parse_command_text(instance);
+    target->word = result;
 
-    if (parser_accept(instance, SYMBOL_READ))
+    if (strpbrk(result, "$`"))
     {
-        size_t offset = instance->index - 1;
-
-        parser_parse_file_name(instance);
+        parser_parse_commands(instance, instruction, result, true);
+    }
+}
 
-        instance->last->read = instance->arguments.buffer[offset];
+static void parser_parse_redirection(Parser instance, Instruction target)
+{
+    Token token = parser_token(instance);
+    Redirection added = arena_allocate_zero(&instance->arena, sizeof * added);
 
-        if (instance->current == SYMBOL_PIPE)
-        {
-            parser_parse_recursive(instance);
-        }
-        else
-        {
-            parser_parse_terminate(instance);
-        }
+    euler_assert(added);
 
-        parser_expect(instance, SYMBOL_NONE);
+    added->descriptor = token->descriptor;
 
-        return;
+    switch (instance->current)
+    {
+    case SYMBOL_READ: added->type = REDIRECTION_READ; break;
+    case SYMBOL_WRITE: added->type = REDIRECTION_WRITE; break;
+    case SYMBOL_APPEND: added->type = REDIRECTION_APPEND; break;
+    case SYMBOL_HEREDOC: added->type = REDIRECTION_DOCUMENT; break;
+    case SYMBOL_HERESTRING: added->type = REDIRECTION_STRING; break;
+    default: added->type = REDIRECTION_DUPLICATE; break;
     }
 
-    if (instance->current == SYMBOL_PIPE)
+    parser_next(instance);
+
+    if (!parser_is_word(instance->current))
     {
-        parser_parse_recursive(instance);
-        parser_expect(instance, SYMBOL_NONE);
+        instance->faulted = true;
 
         return;
     }
 
-    parser_parse_terminate(instance);
+    Token word = parser_token(instance);
+
+    parser_next(instance);
 
-    if (parser_accept(instance, SYMBOL_READ))
+    if (added->type == REDIRECTION_DOCUMENT)
     {
-        size_t offset = instance->index - 1;
+        parser_parse_document(
+            instance,
+            target,
+            added,
+            word,
+            token->length == 3);
+    }
+    else
+    {
+        added->word = parser_copy_word(instance, target, word);
+    }
+
+    if (instance->faulted)
+    {
+        return;
+    }
 
-        parser_parse_file_name(instance);
+    Redirection* last = &target->redirections;
 
-        instance->last->read = instance->arguments.buffer[offset];
+    while (*last)
+    {
+        last = &(*last)->next;
     }
 
-    parser_expect(instance, SYMBOL_NONE);
+    *last = added;
 }
 
-Exception parser_parse(Parser instance, String value, size_t length)
+static Handler parser_find_handler(Symbol symbol, size_t length)
 {
-    parser_reset(instance);
-    argument_vector_clear(&instance->arguments);
-    
-    while (isspace(value[length - 1]))
+    switch (symbol)
     {
-        length--;
+    case SYMBOL_CHANGE_DIRECTORY:
+        return length <= 2 ? change_directory_handler : NULL;
+
+    case SYMBOL_EXIT: return length == 1 ? exit_handler : NULL;
+    case SYMBOL_FOREGROUND: return length == 2 ? foreground_handler : NULL;
+    case SYMBOL_BACKGROUND: return length == 2 ? background_handler : NULL;
+    case SYMBOL_JOBS: return length <= 2 ? jobs_handler : NULL;
+    case SYMBOL_HASH: return hash_handler;
+    default: return NULL;
     }
+}
 
-    if (!length)
+static bool parser_is_assignment(Token token)
+{
+    if (token->symbol != SYMBOL_STRING)
     {
-        return 0;
+        return false;
     }
 
-    String duplicate = malloc(length + 1);
+    String separator = memchr(token->value, '=', token->length);
+
+    return separator &&
+        variable_table_is_name(token->value, separator - token->value);
+}
+
+static Instruction parser_parse_command_text(Parser instance)
+{
+    size_t offset = instance->index - 1;
+    size_t length = 0;
 
-    if (!duplicate)
+    for (size_t i = offset; i < instance->lexer.count; i++)
     {
-        return EXCEPTION_OUT_OF_MEMORY;
+        Symbol symbol = instance->lexer.items[i].symbol;
+
+        if (parser_is_redirection(symbol))
+        {
+            i++;
+        }
+        else if (symbol == SYMBOL_DOCUMENT)
+        {
+            continue;
+        }
+        else if (parser_is_word(symbol))
+        {
+            length++;
+        }
+        else
+        {
+            break;
+        }
     }
 
-    memcpy(duplicate, value, length);
+    Instruction result = parser_add(instance, INSTRUCTION_COMMAND, NULL);
+    Symbol name = SYMBOL_NONE;
 
-    duplicate[length] = '\0';
-    
-    Exception ex = argument_vector_tokenize(&instance->arguments, value);
+    result->words = arena_allocate(
+        &instance->arena,
+        (length + 1) * sizeof * result->words);
+    result->assignments = arena_allocate(
+        &instance->arena,
+        (length + 1) * sizeof * result->assignments);
 
-    if (ex)
+    euler_assert(result->words);
+    euler_assert(result->assignments);
+
+    length = 0;
+
+    while (!instance->faulted)
     {
-        return ex;
+        if (parser_is_redirection(instance->current))
+        {
+            parser_parse_redirection(instance, result);
+
+            continue;
+        }
+
+        if (!parser_is_word(instance->current))
+        {
+            break;
+        }
+
+        Token token = parser_token(instance);
+
+        if (!length && parser_is_assignment(token))
+        {
+            result->assignments[result->assignmentCount] = parser_copy_word(
+                instance,
+                result,
+                token);
+            result->assignmentCount++;
+
+            parser_next(instance);
+
+            continue;
+        }
+
+        if (!length)
+        {
+            name = instance->current;
+        }
+
+        result->words[length] = parser_copy_word(instance, result, token);
+        length++;
+
+        parser_next(instance);
     }
 
-    instance->text = duplicate;
+    result->wordCount = length;
+    result->words[length] = NULL;
+    result->assignments[result->assignmentCount] = NULL;
 
-    if (!instance->arguments.count)
+    if (!length && result->assignmentCount && !result->redirections)
     {
-        return 0;
+        result->execute = assignment_handler;
+
+        return result;
     }
 
-    job_collection_garbage_collect(&instance->jobs);
-    parser_next(instance);
-    parser_parse_command(instance);
+    if (!length)
+    {
+        instance->faulted = true;
+
+        return result;
+    }
+
+    if (name >= SYMBOL_CHANGE_DIRECTORY && name <= SYMBOL_HASH)
+    {
+        result->execute = parser_find_handler(name, length);
+
+        if (!result->execute || result->redirections)
+        {
+            instance->faulted = true;
+        }
+    }
+
+    return result;
+}
+
+static Instruction parser_parse_compound_list(Parser instance)
+{
+    parser_skip_separators(instance);
+
+    if (!instance->faulted && instance->current == SYMBOL_NONE)
+    {
+        instance->incomplete = true;
+    }
+
+    return parser_parse_list(instance);
+}
+
+static Instruction parser_parse_if(Parser instance)
+{
+    Instruction result = parser_add(instance, INSTRUCTION_IF, if_handler);
+
+    result->left = parser_parse_compound_list(instance);
+
+    parser_expect_keyword(instance, SYMBOL_THEN);
+
+    result->right = parser_parse_compound_list(instance);
+
+    if (parser_accept(instance, SYMBOL_ELIF))
+    {
+        result->alternative = parser_parse_if(instance);
+
+        return result;
+    }
+
+    if (parser_accept(instance, SYMBOL_ELSE))
+    {
+        result->alternative = parser_parse_compound_list(instance);
+    }
+
+    parser_expect_keyword(instance, SYMBOL_FI);
+
+    return result;
+}
+
+static Instruction parser_parse_while(Parser instance, InstructionType type)
+{
+    Instruction result = parser_add(instance, type, while_handler);
+
+    result->left = parser_parse_compound_list(instance);
+
+    parser_expect_keyword(instance, SYMBOL_DO);
+
+    result->right = parser_parse_compound_list(instance);
+
+    parser_expect_keyword(instance, SYMBOL_DONE);
+
+    return result;
+}
+
+static Instruction parser_parse_for(Parser instance)
+{
+    Instruction result = parser_add(instance, INSTRUCTION_FOR, for_handler);
+    Token token = parser_token(instance);
+
+    if (!parser_is_word(instance->current) ||
+        !variable_table_is_name(token->value, token->length))
+    {
+        if (!instance->faulted && instance->current == SYMBOL_NONE)
+        {
+            instance->incomplete = true;
+        }
+
+        instance->faulted = true;
+
+        return result;
+    }
+
+    result->name = parser_copy(instance, token);
+
+    parser_next(instance);
+
+    size_t length = 0;
+
+    if (parser_accept(instance, SYMBOL_IN))
+    {
+        for (size_t i = instance->index - 1;
+            i < instance->lexer.count &&
+            parser_is_word(instance->lexer.items[i].symbol);
+            i++)
+        {
+            length++;
+        }
+    }
+
+    result->words = arena_allocate(
+        &instance->arena,
+        (length + 1) * sizeof * result->words);
+
+    euler_assert(result->words);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        result->words[i] = parser_copy_word(
+            instance,
+            result,
+            parser_token(instance));
+
+        parser_next(instance);
+    }
+
+    result->wordCount = length;
+    result->words[length] = NULL;
+
+    parser_skip_separators(instance);
+    parser_expect_keyword(instance, SYMBOL_DO);
+
+    result->right = parser_parse_compound_list(instance);
+
+    parser_expect_keyword(instance, SYMBOL_DONE);
+
+    return result;
+}
+
+static Instruction parser_parse_command(Parser instance)
+{
+    size_t offset = instance->index - 1;
+    Instruction result;
+
+    switch (instance->current)
+    {
+    case SYMBOL_OPEN:
+        parser_next(instance);
+
+        result = parser_add(instance, INSTRUCTION_SUBSHELL, NULL);
+        result->left = parser_parse_list(instance);
+
+        parser_expect(instance, SYMBOL_CLOSE);
+        break;
+
+    case SYMBOL_IF:
+        parser_next(instance);
+
+        result = parser_parse_if(instance);
+        break;
+
+    case SYMBOL_WHILE:
+        parser_next(instance);
+
+        result = parser_parse_while(instance, INSTRUCTION_WHILE);
+        break;
+
+    case SYMBOL_UNTIL:
+        parser_next(instance);
+
+        result = parser_parse_while(instance, INSTRUCTION_UNTIL);
+        break;
+
+    case SYMBOL_FOR:
+        parser_next(instance);
+
+        result = parser_parse_for(instance);
+        break;
+
+    default: return parser_parse_command_text(instance);
+    }
+
+    // Compound commands run in the shell process unless they are a pipeline
+    // stage or carry redirections, in which case they run in a subshell.
+
+    bool piped = offset &&
+        instance->lexer.items[offset - 1].symbol == SYMBOL_PIPE;
+
+    if (result->execute &&
+        (piped ||
+            instance->current == SYMBOL_PIPE ||
+            parser_is_redirection(instance->current)))
+    {
+        Instruction subshell = parser_add(
+            instance,
+            INSTRUCTION_SUBSHELL,
+            NULL);
+
+        subshell->left = result;
+        result = subshell;
+    }
+
+    while (!instance->faulted && parser_is_redirection(instance->current))
+    {
+        parser_parse_redirection(instance, result);
+    }
+
+    return result;
+}
+
+static Instruction parser_parse_pipeline(Parser instance)
+{
+    if (parser_accept(instance, SYMBOL_TIME))
+    {
+        Instruction result = parser_add(
+            instance,
+            INSTRUCTION_TIME,
+            time_handler);
+
+        result->left = parser_parse_pipeline(instance);
+
+        return result;
+    }
+
+    size_t offset = instance->index - 1;
+    Instruction first = parser_parse_command(instance);
+    Instruction last = first;
+    size_t count = 1;
+
+    while (!instance->faulted && parser_accept(instance, SYMBOL_PIPE))
+    {
+        last->right = parser_parse_command(instance);
+        last = last->right;
+        count++;
+    }
+
+    if (count == 1 && first->execute)
+    {
+        return first;
+    }
+
+    Instruction result = parser_add(
+        instance,
+        INSTRUCTION_PIPELINE,
+        execute_handler);
+
+    result->stageCount = count;
+    result->stages = arena_allocate(
+        &instance->arena,
+        count * sizeof * result->stages);
+    result->text = parser_copy_text(instance, offset);
+
+    euler_assert(result->stages);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (first->execute)
+        {
+            instance->faulted = true;
+        }
+
+        result->stages[i] = first;
+        first = first->right;
+        result->stages[i]->right = NULL;
+    }
+
+    return result;
+}
+
+static Instruction parser_parse_and_or(Parser instance)
+{
+    Instruction result = parser_parse_pipeline(instance);
+
+    while (!instance->faulted)
+    {
+        Instruction added;
+
+        if (parser_accept(instance, SYMBOL_AND))
+        {
+            added = parser_add(instance, INSTRUCTION_AND, and_handler);
+        }
+        else if (parser_accept(instance, SYMBOL_OR))
+        {
+            added = parser_add(instance, INSTRUCTION_OR, or_handler);
+        }
+        else
+        {
+            break;
+        }
+
+        added->left = result;
+        added->right = parser_parse_pipeline(instance);
+        result = added;
+    }
+
+    return result;
+}
+
+static Instruction parser_parse_background(
+    Parser instance,
+    Instruction value,
+    size_t offset)
+{
+    if (value->type == INSTRUCTION_COMMAND)
+    {
+        instance->faulted = true;
+
+        return value;
+    }
+
+    if (value->type != INSTRUCTION_PIPELINE)
+    {
+        Instruction subshell = parser_add(
+            instance,
+            INSTRUCTION_SUBSHELL,
+            NULL);
+        Instruction pipeline = parser_add(
+            instance,
+            INSTRUCTION_PIPELINE,
+            execute_handler);
+
+        pipeline->stageCount = 1;
+        pipeline->stages = arena_allocate(
+            &instance->arena,
+            sizeof * pipeline->stages);
+
+        euler_assert(pipeline->stages);
+
+        subshell->left = value;
+        pipeline->stages[0] = subshell;
+        value = pipeline;
+    }
+
+    value->background = true;
+    value->text = parser_copy_text(instance, offset);
+
+    return value;
+}
+
+static Instruction parser_parse_list(Parser instance)
+{
+    Instruction result = NULL;
+
+    while (!instance->faulted && !parser_is_terminator(instance->current))
+    {
+        size_t offset = instance->index - 1;
+        Instruction item = parser_parse_and_or(instance);
+
+        if (parser_accept(instance, SYMBOL_AMPERSAND))
+        {
+            item = parser_parse_background(instance, item, offset);
+        }
+        else if (!parser_accept(instance, SYMBOL_SEMICOLON) &&
+            !parser_is_terminator(instance->current))
+        {
+            instance->faulted = true;
+        }
+
+        parser_skip_separators(instance);
+
+        if (!result)
+        {
+            result = item;
+
+            continue;
+        }
+
+        Instruction added = parser_add(
+            instance,
+            INSTRUCTION_SEQUENCE,
+            sequence_handler);
+
+        added->left = result;
+        added->right = item;
+        result = added;
+    }
+
+    if (!result)
+    {
+        instance->faulted = true;
+    }
+
+    return result;
+}
+
+static Exception parser_compile(Parser instance, String value, size_t length)
+{
+    instance->text = arena_copy(&instance->arena, value, length);
+
+    if (!instance->text)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    uint64_t start = trace_now();
+    Exception ex = lexer_tokenize(&instance->lexer, instance->text, length);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    trace_event(TRACE_TOKENIZE, start, instance->lexer.count, 0, NULL);
+
+    if (!instance->lexer.count)
+    {
+        return 0;
+    }
+
+    start = trace_now();
+
+    parser_next(instance);
+
+    instance->root = parser_parse_list(instance);
+
+    parser_expect(instance, SYMBOL_NONE);
+    trace_event(TRACE_PARSE, start, 0, instance->faulted, instance->text);
+
+    if (instance->faulted)
+    {
+        instance->root = NULL;
+    }
+
+    return 0;
+}
+
+Exception parser_parse(Parser instance, String value, size_t length)
+{
+    parser_reset(instance);
+    lexer_clear(&instance->lexer);
+    
+    while (length && isspace(value[length - 1]))
+    {
+        length--;
+    }
+
+    if (!length)
+    {
+        return 0;
+    }
+
+    if (memchr(value, '!', length))
+    {
+        String expanded;
+        size_t expandedLength;
+        Exception ex = history_expand(
+            &instance->history,
+            &instance->arena,
+            value,
+            length,
+            &expanded,
+            &expandedLength);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        if (!expanded)
+        {
+            instance->faulted = true;
+
+            return 0;
+        }
+
+        if (expandedLength != length || memcmp(expanded, value, length) != 0)
+        {
+            printf("%s\n", expanded);
+        }
+
+        value = expanded;
+        length = expandedLength;
+    }
+
+    bool admit;
+    ParseCacheEntry entry = parse_cache_find(
+        &instance->cache,
+        value,
+        length,
+        &admit);
+
+    if (entry)
+    {
+        instance->text = entry->text;
+        instance->root = entry->root;
+
+        trace_event(TRACE_PARSE, 0, 1, 0, instance->text);
+
+        return 0;
+    }
+
+    if (!admit)
+    {
+        return parser_compile(instance, value, length);
+    }
+
+    struct Arena line = instance->arena;
+
+    arena(&instance->arena, 0);
+
+    Exception ex = parser_compile(instance, value, length);
+
+    if (!ex && instance->root)
+    {
+        ex = parse_cache_add(
+            &instance->cache,
+            instance->text,
+            length,
+            instance->root,
+            &instance->arena);
+
+        arena_move(&instance->arena, &line);
+
+        return ex;
+    }
+
+    finalize_arena(&line);
+
+    return ex;
+}
+
+bool parser_execute(Parser instance, Instruction instruction)
+{
+    size_t descriptorCount = instance->descriptorCount;
+    size_t processCount = instance->processCount;
+
+    if (instruction->type == INSTRUCTION_COMMAND ||
+        instruction->type == INSTRUCTION_FOR)
+    {
+        euler_ok(expansion_expand(instance, instruction));
+    }
+
+    if (instruction->type == INSTRUCTION_COMMAND)
+    {
+        instance->pipeStatusCount = 0;
+    }
+
+    bool result = instruction->execute(instance, instruction);
+
+    // Special built-in commands and assignments run without a job. Unless
+    // they waited for one, as fg does, they count as a one-stage pipeline.
+
+    if (instruction->type == INSTRUCTION_COMMAND &&
+        !instance->pipeStatusCount)
+    {
+        if (!instance->pipeStatusCapacity)
+        {
+            instance->pipeStatus = malloc(sizeof * instance->pipeStatus);
+
+            euler_assert(instance->pipeStatus);
+
+            instance->pipeStatusCapacity = 1;
+        }
+
+        instance->pipeStatus[0] = instance->status;
+        instance->pipeStatusCount = 1;
+    }
+
+    parser_close_descriptors(instance, descriptorCount);
+    parser_wait_processes(instance, processCount);
+
+    return result;
+}
+
+Exception parser_add_descriptor(Parser instance, int descriptor)
+{
+    if (instance->descriptorCount == instance->descriptorCapacity)
+    {
+        size_t newCapacity = instance->descriptorCapacity * 2;
+
+        if (!newCapacity)
+        {
+            newCapacity = 4;
+        }
+
+        int* newDescriptors = realloc(
+            instance->descriptors,
+            newCapacity * sizeof * newDescriptors);
+
+        if (!newDescriptors)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->descriptorCapacity = newCapacity;
+        instance->descriptors = newDescriptors;
+    }
+
+    instance->descriptors[instance->descriptorCount] = descriptor;
+    instance->descriptorCount++;
+
+    return 0;
+}
+
+void parser_close_descriptors(Parser instance, size_t count)
+{
+    while (instance->descriptorCount > count)
+    {
+        instance->descriptorCount--;
+
+        close(instance->descriptors[instance->descriptorCount]);
+    }
+}
+
+Exception parser_add_process(Parser instance, pid_t process)
+{
+    if (instance->processCount == instance->processCapacity)
+    {
+        size_t newCapacity = instance->processCapacity * 2;
+
+        if (!newCapacity)
+        {
+            newCapacity = 4;
+        }
+
+        pid_t* newProcesses = realloc(
+            instance->processes,
+            newCapacity * sizeof * newProcesses);
+
+        if (!newProcesses)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->processCapacity = newCapacity;
+        instance->processes = newProcesses;
+    }
+
+    instance->processes[instance->processCount] = process;
+    instance->processCount++;
+
+    return 0;
+}
+
+void parser_wait_processes(Parser instance, size_t count)
+{
+    // Process substitutions run outside any job, so nothing else waits for
+    // them. Their descriptors are closed first, so a writer blocked on a
+    // full pipe sees EPIPE rather than hanging the shell.
+
+    while (instance->processCount > count)
+    {
+        instance->processCount--;
+
+        pid_t process = instance->processes[instance->processCount];
+        pid_t result;
+
+        do
+        {
+            result = waitpid(process, NULL, 0);
+        }
+        while (result == -1 && errno == EINTR);
+    }
+}
+
+Exception parser_set_status(Parser instance, Job value)
+{
+    if (value->count > instance->pipeStatusCapacity)
+    {
+        int* newPipeStatus = realloc(
+            instance->pipeStatus,
+            value->count * sizeof * newPipeStatus);
+
+        if (!newPipeStatus)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->pipeStatusCapacity = value->count;
+        instance->pipeStatus = newPipeStatus;
+    }
+
+    for (size_t i = 0; i < value->count; i++)
+    {
+        instance->pipeStatus[i] = job_status_code(value->statuses[i]);
+    }
+
+    instance->pipeStatusCount = value->count;
+    instance->status = instance->pipeStatus[value->count - 1];
+
+    return 0;
+}
+
+Exception parser_set_variable(Parser instance, String name, String value)
+{
+    size_t length = strlen(name);
+    Exception ex = variable_table_set(
+        &instance->variables,
+        name,
+        length,
+        value);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    return variable_table_export(&instance->variables, name, length);
+}
+
+Exception parser_set_working_directory(Parser instance)
+{
+    directory_cache_clear(&instance->directories);
+
+    if (!instance->workingDirectory)
+    {
+        instance->workingDirectoryCapacity = PATH_MAX;
+        instance->workingDirectory = malloc(instance->workingDirectoryCapacity);
+
+        if (!instance->workingDirectory)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->workingDirectory[0] = '\0';
+    }
+
+    errno = 0;
+
+    while (!getcwd(
+        instance->workingDirectory,
+        instance->workingDirectoryCapacity))
+    {
+        if (errno != ERANGE)
+        {
+            return 0;
+        }
+
+        size_t newCapacity = instance->workingDirectoryCapacity * 2;
+        String newWorkingDirectory = realloc(
+            instance->workingDirectory,
+            newCapacity);
+
+        if (!newWorkingDirectory)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->workingDirectoryCapacity = newCapacity;
+        instance->workingDirectory = newWorkingDirectory;
+    }
+
+    Exception ex = parser_set_variable(
+        instance,
+        PARSER_WORKING_DIRECTORY,
+        instance->workingDirectory);
+
+    if (ex)
+    {
+        return ex;
+    }
+
+    String name = strrchr(instance->workingDirectory, '/');
+
+    if (!name || !name[1])
+    {
+        name = instance->workingDirectory;
+    }
+    else
+    {
+        name++;
+    }
+
+    size_t length = strlen(name) + sizeof PARSER_PROMPT_FORMAT;
+    String newPrompt = realloc(instance->prompt, length);
+
+    if (!newPrompt)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    snprintf(newPrompt, length, PARSER_PROMPT_FORMAT, name);
+
+    instance->prompt = newPrompt;
 
     return 0;
 }
@@ -381,6 +1532,28 @@ Exception parser_parse(Parser instance, String value, size_t length)
 void finalize_parser(Parser instance)
 {
     parser_reset(instance);
+    finalize_parallel_handler(instance);
     finalize_job_collection(&instance->jobs);
-    finalize_argument_vector(&instance->arguments);
+    finalize_command_table(&instance->commands);
+    finalize_lexer(&instance->lexer);
+    finalize_parse_cache(&instance->cache);
+    finalize_arena(&instance->arena);
+    finalize_history(&instance->history);
+    finalize_variable_table(&instance->variables);
+    free(instance->pipeStatus);
+    free(instance->workingDirectory);
+    free(instance->prompt);
+    free(instance->descriptors);
+    free(instance->processes);
+
+    instance->pipeStatus = NULL;
+    instance->workingDirectory = NULL;
+    instance->workingDirectoryCapacity = 0;
+    instance->prompt = NULL;
+    instance->descriptors = NULL;
+    instance->descriptorCapacity = 0;
+    instance->processes = NULL;
+    instance->processCapacity = 0;
+    instance->pipeStatusCapacity = 0;
+    instance->pipeStatusCount = 0;
 }
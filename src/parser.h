@@ -4,26 +4,70 @@
 
 // References:
 //  - https://en.wikipedia.org/wiki/Recursive_descent_parser
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
 
+#ifndef PARSER_0c44498f69474fe1b3932edf17d51c15
+#define PARSER_0c44498f69474fe1b3932edf17d51c15
+#include <sys/types.h>
 #include <stdbool.h>
-#include "argument_vector.h"
+#include "arena.h"
+#include "command_table.h"
+#include "directory_cache.h"
+#include "history.h"
 #include "job_collection.h"
+#include "lexer.h"
+#include "parse_cache.h"
 #include "symbol.h"
+#include "variable_table.h"
+
+struct Parallel;
 
 struct Parser
 {
     bool faulted;
+    bool incomplete;
+    bool substituted;
+    int status;
+    pid_t id;
+    size_t pipeStatusCount;
+    size_t pipeStatusCapacity;
+    int* pipeStatus;
+    size_t descriptorCount;
+    size_t descriptorCapacity;
+    int* descriptors;
+    size_t processCount;
+    size_t processCapacity;
+    pid_t* processes;
+    size_t workingDirectoryCapacity;
+    char* workingDirectory;
+    char* prompt;
     enum Symbol current;
     size_t index;
     struct JobCollection jobs;
-    struct ArgumentVector arguments;
+    struct CommandTable commands;
+    struct History history;
+    struct VariableTable variables;
+    struct DirectoryCache directories;
+    struct ParseCache cache;
+    struct Lexer lexer;
+    struct Arena arena;
     char* text;
-    struct Instruction* first;
-    struct Instruction* last;
+    struct Instruction* root;
+    struct Parallel* pools;
 };
 
 typedef struct Parser* Parser;
 
 Exception parser(Parser instance);
 Exception parser_parse(Parser instance, String value, size_t length);
+bool parser_execute(Parser instance, Instruction instruction);
+Exception parser_set_status(Parser instance, Job value);
+Exception parser_set_variable(Parser instance, String name, String value);
+Exception parser_set_working_directory(Parser instance);
+Exception parser_add_descriptor(Parser instance, int descriptor);
+void parser_close_descriptors(Parser instance, size_t count);
+Exception parser_add_process(Parser instance, pid_t process);
+void parser_wait_processes(Parser instance, size_t count);
 void finalize_parser(Parser instance);
+
+#endif
@@ -0,0 +1,179 @@
+// pattern.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+//  - https://research.swtch.com/glob
+
+#include <stddef.h>
+#include "pattern.h"
+
+bool pattern_is_literal(String pattern)
+{
+    for (String p = pattern; *p; p++)
+    {
+        switch (*p)
+        {
+        case '*':
+        case '?':
+        case '[':
+            return false;
+
+        case '\\':
+            if (p[1])
+            {
+                p++;
+            }
+
+            break;
+        }
+    }
+
+    return true;
+}
+
+static size_t pattern_match_class(String pattern, unsigned char value)
+{
+    String p = pattern + 1;
+    bool negated = *p == '!' || *p == '^';
+    bool matched = false;
+
+    if (negated)
+    {
+        p++;
+    }
+
+    String first = p;
+
+    while (*p && (*p != ']' || p == first))
+    {
+        unsigned char low = *p;
+
+        if (low == '\\' && p[1])
+        {
+            p++;
+            low = *p;
+        }
+
+        unsigned char high = low;
+
+        if (p[1] == '-' && p[2] && p[2] != ']')
+        {
+            p += 2;
+            high = *p;
+
+            if (high == '\\' && p[1])
+            {
+                p++;
+                high = *p;
+            }
+        }
+
+        if (value >= low && value <= high)
+        {
+            matched = true;
+        }
+
+        p++;
+    }
+
+    if (!*p)
+    {
+        return value == '[';
+    }
+
+    if (matched == negated)
+    {
+        return 0;
+    }
+
+    return p + 1 - pattern;
+}
+
+static size_t pattern_match_one(String pattern, unsigned char value)
+{
+    switch (*pattern)
+    {
+    case '?':
+        return 1;
+
+    case '[':
+        return pattern_match_class(pattern, value);
+
+    case '\\':
+        if (pattern[1])
+        {
+            return ((unsigned char)pattern[1] == value) * 2;
+        }
+
+        break;
+    }
+
+    return (unsigned char)*pattern == value;
+}
+
+bool pattern_match(String pattern, String value)
+{
+    String star = NULL;
+    String resume = NULL;
+
+    while (*value)
+    {
+        if (*pattern == '*')
+        {
+            pattern++;
+            star = pattern;
+            resume = value;
+
+            continue;
+        }
+
+        size_t length = 0;
+
+        if (*pattern)
+        {
+            length = pattern_match_one(pattern, *value);
+        }
+
+        if (length)
+        {
+            pattern += length;
+            value++;
+
+            continue;
+        }
+
+        if (!star)
+        {
+            return false;
+        }
+
+        resume++;
+        pattern = star;
+        value = resume;
+    }
+
+    while (*pattern == '*')
+    {
+        pattern++;
+    }
+
+    return !*pattern;
+}
+
+void pattern_unescape(String result, String pattern)
+{
+    for (String p = pattern; *p; p++)
+    {
+        if (*p == '\\' && p[1])
+        {
+            p++;
+        }
+
+        *result = *p;
+        result++;
+    }
+
+    *result = '\0';
+}
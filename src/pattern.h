@@ -0,0 +1,18 @@
+// pattern.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+//  - https://research.swtch.com/glob
+
+#ifndef PATTERN_4a9d2e7f1c3b4e8a9d5f6b0c2e1a7d3f
+#define PATTERN_4a9d2e7f1c3b4e8a9d5f6b0c2e1a7d3f
+#include <stdbool.h>
+#include "euler.h"
+
+bool pattern_is_literal(String pattern);
+bool pattern_match(String pattern, String value);
+void pattern_unescape(String result, String pattern);
+
+#endif
@@ -0,0 +1,32 @@
+// print_working_directory_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/pwd.html
+
+#include <string.h>
+#include "handler.h"
+#include "stream.h"
+
+bool print_working_directory_handler_accepts(Instruction instruction)
+{
+    return instruction->length == 1;
+}
+
+int print_working_directory_handler(
+    Parser state,
+    EULER_UNUSED Instruction instruction,
+    EULER_UNUSED int input,
+    int output)
+{
+    size_t length = strlen(state->workingDirectory);
+
+    state->workingDirectory[length] = '\n';
+
+    bool result = stream_write(output, state->workingDirectory, length + 1);
+
+    state->workingDirectory[length] = '\0';
+
+    return !result;
+}
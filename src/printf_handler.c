@@ -0,0 +1,364 @@
+// printf_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/printf.html
+//  - https://www.man7.org/linux/man-pages/man3/open_memstream.3.html
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "handler.h"
+#include "stream.h"
+#define PRINTF_HANDLER_FLAGS "-+ #0123456789."
+#define PRINTF_HANDLER_CONVERSIONS "aAbcdeEfFgGiosuxX"
+
+// Writes the escape sequence after a backslash and returns the number of
+// characters it used. In a %b argument, octal escapes take a leading zero
+// and \c ends the output.
+
+static size_t printf_handler_escape(
+    FILE* stream,
+    String value,
+    bool argument,
+    bool* stopped)
+{
+    String p = value;
+    int result = 0;
+
+    switch (*p)
+    {
+    case 'a': fputc('\a', stream); return 1;
+    case 'b': fputc('\b', stream); return 1;
+    case 'f': fputc('\f', stream); return 1;
+    case 'n': fputc('\n', stream); return 1;
+    case 'r': fputc('\r', stream); return 1;
+    case 't': fputc('\t', stream); return 1;
+    case 'v': fputc('\v', stream); return 1;
+    case '\\': fputc('\\', stream); return 1;
+    case 'c':
+        if (argument)
+        {
+            *stopped = true;
+
+            return 1;
+        }
+
+        break;
+    }
+
+    if (argument && *p == '0')
+    {
+        p++;
+    }
+
+    if (*p < '0' || *p > '7')
+    {
+        fputc('\\', stream);
+
+        return 0;
+    }
+
+    for (int i = 0; i < 3 && *p >= '0' && *p <= '7'; i++)
+    {
+        result = result * 8 + *p - '0';
+        p++;
+    }
+
+    fputc(result, stream);
+
+    return p - value;
+}
+
+bool printf_handler_accepts(Instruction instruction)
+{
+    if (instruction->length < 2)
+    {
+        return true;
+    }
+
+    for (String p = instruction->arguments[1]; (p = strchr(p, '%')); p++)
+    {
+        if (p[1] == '%')
+        {
+            p++;
+
+            continue;
+        }
+
+        p += strspn(p + 1, PRINTF_HANDLER_FLAGS) + 1;
+
+        if (!*p || !strchr(PRINTF_HANDLER_CONVERSIONS, *p))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool printf_handler_integer(String value, long long* result)
+{
+    char* end;
+
+    *result = strtoll(value, &end, 0);
+
+    if (*value && !*end)
+    {
+        return true;
+    }
+
+    fprintf(stderr, "Error: invalid number\n");
+
+    return false;
+}
+
+static bool printf_handler_real(String value, double* result)
+{
+    char* end;
+
+    *result = strtod(value, &end);
+
+    if (*value && !*end)
+    {
+        return true;
+    }
+
+    fprintf(stderr, "Error: invalid number\n");
+
+    return false;
+}
+
+static void printf_handler_string(
+    FILE* stream,
+    String specification,
+    String value,
+    bool* stopped)
+{
+    char* buffer;
+    size_t length;
+    FILE* decoded = open_memstream(&buffer, &length);
+
+    euler_assert(decoded);
+
+    for (String p = value; *p && !*stopped; p++)
+    {
+        if (*p == '\\' && p[1])
+        {
+            p += printf_handler_escape(decoded, p + 1, true, stopped);
+
+            continue;
+        }
+
+        fputc(*p, decoded);
+    }
+
+    euler_assert(fclose(decoded) == 0);
+    fprintf(stream, specification, buffer);
+    free(buffer);
+}
+
+static bool printf_handler_format(
+    FILE* stream,
+    String format,
+    String** arguments,
+    String* end,
+    bool* stopped)
+{
+    bool result = true;
+    char specification[32];
+    char character[2] = { '\0', '\0' };
+
+    for (String p = format; *p && !*stopped; p++)
+    {
+        if (*p == '\\' && p[1])
+        {
+            p += printf_handler_escape(stream, p + 1, false, stopped);
+
+            continue;
+        }
+
+        if (*p != '%')
+        {
+            fputc(*p, stream);
+
+            continue;
+        }
+
+        if (p[1] == '%')
+        {
+            p++;
+
+            fputc('%', stream);
+
+            continue;
+        }
+
+        size_t length = strspn(p + 1, PRINTF_HANDLER_FLAGS) + 1;
+
+        if (length + 3 > sizeof specification || !p[length])
+        {
+            fputs(p, stream);
+
+            break;
+        }
+
+        char conversion = p[length];
+        String argument = "";
+
+        if (!strchr(PRINTF_HANDLER_CONVERSIONS, conversion))
+        {
+            fwrite(p, 1, length + 1, stream);
+
+            p += length;
+
+            continue;
+        }
+
+        if (*arguments < end)
+        {
+            argument = **arguments;
+            (*arguments)++;
+        }
+
+        memcpy(specification, p, length);
+
+        p += length;
+
+        long long integer = 0;
+        double real = 0;
+
+        switch (conversion)
+        {
+        case 'c':
+            character[0] = *argument;
+            argument = character;
+            specification[length] = 's';
+            specification[length + 1] = '\0';
+
+            fprintf(stream, specification, argument);
+
+            break;
+
+        case 's':
+            specification[length] = 's';
+            specification[length + 1] = '\0';
+
+            fprintf(stream, specification, argument);
+
+            break;
+
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            specification[length] = 'l';
+            specification[length + 1] = 'l';
+            specification[length + 2] = conversion;
+            specification[length + 3] = '\0';
+
+            if (!*argument)
+            {
+                integer = 0;
+            }
+            else if (!printf_handler_integer(argument, &integer))
+            {
+                result = false;
+            }
+
+            fprintf(stream, specification, integer);
+
+            break;
+
+        case 'b':
+            specification[length] = 's';
+            specification[length + 1] = '\0';
+
+            printf_handler_string(stream, specification, argument, stopped);
+
+            break;
+
+        case 'a':
+        case 'A':
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+            specification[length] = conversion;
+            specification[length + 1] = '\0';
+
+            if (*argument && !printf_handler_real(argument, &real))
+            {
+                result = false;
+            }
+
+            fprintf(stream, specification, real);
+
+            break;
+        }
+    }
+
+    return result;
+}
+
+int printf_handler(
+    EULER_UNUSED Parser state,
+    Instruction instruction,
+    EULER_UNUSED int input,
+    int output)
+{
+    if (instruction->length < 2)
+    {
+        fprintf(stderr, "Error: invalid command\n");
+
+        return 2;
+    }
+
+    char* buffer;
+    size_t length;
+    FILE* stream = open_memstream(&buffer, &length);
+
+    euler_assert(stream);
+
+    String* arguments = instruction->arguments + 2;
+    String* end = instruction->arguments + instruction->length;
+    bool result = true;
+    bool stopped = false;
+
+    do
+    {
+        String* start = arguments;
+
+        if (!printf_handler_format(
+            stream,
+            instruction->arguments[1],
+            &arguments,
+            end,
+            &stopped))
+        {
+            result = false;
+        }
+
+        if (arguments == start || stopped)
+        {
+            break;
+        }
+    }
+    while (arguments < end);
+
+    euler_assert(fclose(stream) == 0);
+
+    if (!stream_write(output, buffer, length))
+    {
+        result = false;
+    }
+
+    free(buffer);
+
+    return !result;
+}
@@ -0,0 +1,14 @@
+// sequence_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+
+#include "handler.h"
+
+bool sequence_handler(Parser state, Instruction instruction)
+{
+    return parser_execute(state, instruction->left) &&
+        parser_execute(state, instruction->right);
+}
@@ -0,0 +1,232 @@
+// stream.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/copy_file_range.2.html
+//  - https://www.man7.org/linux/man-pages/man2/fcntl.2.html
+//  - https://www.man7.org/linux/man-pages/man2/memfd_create.2.html
+//  - https://www.man7.org/linux/man-pages/man7/pipe.7.html
+//  - https://www.man7.org/linux/man-pages/man2/pread.2.html
+//  - https://www.man7.org/linux/man-pages/man2/splice.2.html
+
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include "stream.h"
+#include "trace.h"
+#define STREAM_CHUNK 1048576
+#define STREAM_BUFFER 65536
+
+void stream_set_capacity(int descriptor, size_t capacity)
+{
+    if (capacity)
+    {
+        fcntl(descriptor, F_SETPIPE_SZ, (int)capacity);
+    }
+}
+
+static bool stream_unsupported(void)
+{
+    return errno == EBADF ||
+        errno == EINVAL ||
+        errno == ENOSYS ||
+        errno == EOPNOTSUPP ||
+        errno == EXDEV;
+}
+
+// Filling a here-document body is not output from the command, so it skips
+// the first-byte trace.
+
+static bool stream_write_all(
+    int output,
+    const void* buffer,
+    size_t length,
+    bool traced)
+{
+    const char* p = buffer;
+
+    while (length)
+    {
+        ssize_t written = write(output, p, length);
+
+        if (written == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (traced)
+        {
+            trace_output();
+        }
+
+        p += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+bool stream_write(int output, const void* buffer, size_t length)
+{
+    return stream_write_all(output, buffer, length, true);
+}
+
+static bool stream_read_write(int input, int output)
+{
+    char buffer[STREAM_BUFFER];
+
+    for (;;)
+    {
+        ssize_t count = read(input, buffer, sizeof buffer);
+
+        if (count == -1 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (count <= 0)
+        {
+            return !count;
+        }
+
+        if (!stream_write(output, buffer, count))
+        {
+            return false;
+        }
+    }
+}
+
+bool stream_copy(int input, int output)
+{
+    ssize_t count;
+
+    do
+    {
+        count = copy_file_range(input, NULL, output, NULL, STREAM_CHUNK, 0);
+
+        if (count > 0)
+        {
+            trace_output();
+        }
+    }
+    while (count > 0 || (count == -1 && errno == EINTR));
+
+    if (!count)
+    {
+        return true;
+    }
+
+    if (!stream_unsupported())
+    {
+        return false;
+    }
+
+    do
+    {
+        count = splice(input, NULL, output, NULL, STREAM_CHUNK, SPLICE_F_MOVE);
+
+        if (count > 0)
+        {
+            trace_output();
+        }
+    }
+    while (count > 0 || (count == -1 && errno == EINTR));
+
+    if (!count)
+    {
+        return true;
+    }
+
+    if (!stream_unsupported())
+    {
+        return false;
+    }
+
+    return stream_read_write(input, output);
+}
+
+// A body that fits in one atomic pipe write is queued in a pipe up front.
+// Larger bodies go to a sealed anonymous memory file, so nothing touches the
+// disk and the reader cannot block the shell.
+
+int stream_document(const void* buffer, size_t length)
+{
+    int descriptors[2];
+
+    if (length <= PIPE_BUF && pipe2(descriptors, O_CLOEXEC) != -1)
+    {
+        bool filled = stream_write_all(descriptors[1], buffer, length, false);
+
+        close(descriptors[1]);
+
+        if (!filled)
+        {
+            close(descriptors[0]);
+
+            return -1;
+        }
+
+        return descriptors[0];
+    }
+
+    int result = memfd_create("nyush", MFD_ALLOW_SEALING | MFD_CLOEXEC);
+
+    if (result == -1)
+    {
+        return -1;
+    }
+
+    if (!stream_write_all(result, buffer, length, false) ||
+        lseek(result, 0, SEEK_SET) == -1)
+    {
+        close(result);
+
+        return -1;
+    }
+
+    fcntl(
+        result,
+        F_ADD_SEALS,
+        F_SEAL_GROW | F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_WRITE);
+
+    return result;
+}
+
+int stream_memory(void)
+{
+    return memfd_create("nyush", MFD_CLOEXEC);
+}
+
+size_t stream_read(int input, void* buffer, size_t length)
+{
+    char* p = buffer;
+    size_t result = 0;
+
+    while (result < length)
+    {
+        ssize_t count = pread(input, p + result, length - result, result);
+
+        if (count == -1 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (count <= 0)
+        {
+            break;
+        }
+
+        result += count;
+    }
+
+    return result;
+}
@@ -0,0 +1,17 @@
+// stream.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+#ifndef STREAM_4955dc94a17c40c7ac63e3cadf8d4f88
+#define STREAM_4955dc94a17c40c7ac63e3cadf8d4f88
+#include <stdbool.h>
+#include <stddef.h>
+
+void stream_set_capacity(int descriptor, size_t capacity);
+bool stream_write(int output, const void* buffer, size_t length);
+bool stream_copy(int input, int output);
+int stream_document(const void* buffer, size_t length);
+int stream_memory(void);
+size_t stream_read(int input, void* buffer, size_t length);
+
+#endif
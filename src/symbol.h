@@ -5,20 +5,49 @@
 // References:
 //  - https://en.wikipedia.org/wiki/Recursive_descent_parser
 
+#ifndef SYMBOL_a233badcc06549df86140df10b0fac89
+#define SYMBOL_a233badcc06549df86140df10b0fac89
+
 enum Symbol
 {
     SYMBOL_NONE = 0,
     SYMBOL_CHANGE_DIRECTORY,
     SYMBOL_EXIT,
     SYMBOL_FOREGROUND,
+    SYMBOL_BACKGROUND,
     SYMBOL_JOBS,
+    SYMBOL_HASH,
+    SYMBOL_TIME,
+    SYMBOL_IF,
+    SYMBOL_THEN,
+    SYMBOL_ELIF,
+    SYMBOL_ELSE,
+    SYMBOL_FI,
+    SYMBOL_WHILE,
+    SYMBOL_UNTIL,
+    SYMBOL_FOR,
+    SYMBOL_IN,
+    SYMBOL_DO,
+    SYMBOL_DONE,
     SYMBOL_READ,
     SYMBOL_WRITE,
     SYMBOL_APPEND,
+    SYMBOL_DUPLICATE,
+    SYMBOL_HEREDOC,
+    SYMBOL_HERESTRING,
     SYMBOL_PIPE,
+    SYMBOL_AMPERSAND,
+    SYMBOL_SEMICOLON,
+    SYMBOL_AND,
+    SYMBOL_OR,
+    SYMBOL_OPEN,
+    SYMBOL_CLOSE,
+    SYMBOL_DOCUMENT,
     SYMBOL_STRING,
     SYMBOL_INVALID,
     SYMBOLS
 };
 
 typedef enum Symbol Symbol;
+
+#endif
@@ -0,0 +1,388 @@
+// test_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/test.html
+//  - https://www.man7.org/linux/man-pages/man2/stat.2.html
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "handler.h"
+#define TEST_HANDLER_ERROR 2
+
+struct TestExpression
+{
+    String* arguments;
+    size_t count;
+    size_t index;
+    bool faulted;
+};
+
+typedef struct TestExpression* TestExpression;
+
+static bool test_handler_is_unary(String operator)
+{
+    return operator[0] == '-' &&
+        operator[1] &&
+        !operator[2] &&
+        strchr("bcdefghknprstuwxzGLOS", operator[1]);
+}
+
+static bool test_handler_is_binary(String operator)
+{
+    static const String OPERATORS[] =
+    {
+        "=", "!=", "-eq", "-ne", "-lt", "-le", "-gt", "-ge", "-nt", "-ot", "-ef"
+    };
+
+    for (size_t i = 0; i < sizeof OPERATORS / sizeof * OPERATORS; i++)
+    {
+        if (strcmp(operator, OPERATORS[i]) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int test_handler_unary(String operator, String operand)
+{
+    if (!test_handler_is_unary(operator))
+    {
+        return TEST_HANDLER_ERROR;
+    }
+
+    struct stat status;
+
+    switch (operator[1])
+    {
+    case 'n': return !*operand;
+    case 'z': return !!*operand;
+    case 'r': return access(operand, R_OK) != 0;
+    case 'w': return access(operand, W_OK) != 0;
+    case 'x': return access(operand, X_OK) != 0;
+    case 't': return !isatty(atoi(operand));
+    case 'h':
+    case 'L':
+        return lstat(operand, &status) != 0 || !S_ISLNK(status.st_mode);
+    }
+
+    if (stat(operand, &status) != 0)
+    {
+        return 1;
+    }
+
+    switch (operator[1])
+    {
+    case 'b': return !S_ISBLK(status.st_mode);
+    case 'c': return !S_ISCHR(status.st_mode);
+    case 'd': return !S_ISDIR(status.st_mode);
+    case 'e': return 0;
+    case 'f': return !S_ISREG(status.st_mode);
+    case 'p': return !S_ISFIFO(status.st_mode);
+    case 's': return !status.st_size;
+    case 'S': return !S_ISSOCK(status.st_mode);
+    case 'g': return !(status.st_mode & S_ISGID);
+    case 'u': return !(status.st_mode & S_ISUID);
+    case 'k': return !(status.st_mode & S_ISVTX);
+    case 'G': return status.st_gid != getegid();
+    case 'O': return status.st_uid != geteuid();
+    }
+
+    return TEST_HANDLER_ERROR;
+}
+
+static bool test_handler_integer(String value, long long* result)
+{
+    char* end;
+
+    *result = strtoll(value, &end, 10);
+
+    return *value && !*end;
+}
+
+static int test_handler_compare_files(
+    String left,
+    String operator,
+    String right)
+{
+    struct stat leftStatus;
+    struct stat rightStatus;
+    bool leftFound = stat(left, &leftStatus) == 0;
+    bool rightFound = stat(right, &rightStatus) == 0;
+
+    if (strcmp(operator, "-ef") == 0)
+    {
+        return !leftFound ||
+            !rightFound ||
+            leftStatus.st_dev != rightStatus.st_dev ||
+            leftStatus.st_ino != rightStatus.st_ino;
+    }
+
+    if (strcmp(operator, "-ot") == 0)
+    {
+        struct stat swap = leftStatus;
+        bool found = leftFound;
+
+        leftStatus = rightStatus;
+        leftFound = rightFound;
+        rightStatus = swap;
+        rightFound = found;
+    }
+
+    if (!leftFound)
+    {
+        return 1;
+    }
+
+    if (!rightFound)
+    {
+        return 0;
+    }
+
+    struct timespec a = leftStatus.st_mtim;
+    struct timespec b = rightStatus.st_mtim;
+
+    return a.tv_sec < b.tv_sec ||
+        (a.tv_sec == b.tv_sec && a.tv_nsec <= b.tv_nsec);
+}
+
+static int test_handler_binary(String left, String operator, String right)
+{
+    if (strcmp(operator, "=") == 0)
+    {
+        return strcmp(left, right) != 0;
+    }
+
+    if (strcmp(operator, "!=") == 0)
+    {
+        return strcmp(left, right) == 0;
+    }
+
+    if (strcmp(operator, "-nt") == 0 ||
+        strcmp(operator, "-ot") == 0 ||
+        strcmp(operator, "-ef") == 0)
+    {
+        return test_handler_compare_files(left, operator, right);
+    }
+
+    long long a;
+    long long b;
+
+    if (operator[0] != '-' ||
+        !test_handler_integer(left, &a) ||
+        !test_handler_integer(right, &b))
+    {
+        return TEST_HANDLER_ERROR;
+    }
+
+    String p = operator + 1;
+
+    if (strcmp(p, "eq") == 0)
+    {
+        return a != b;
+    }
+
+    if (strcmp(p, "ne") == 0)
+    {
+        return a == b;
+    }
+
+    if (strcmp(p, "lt") == 0)
+    {
+        return a >= b;
+    }
+
+    if (strcmp(p, "le") == 0)
+    {
+        return a > b;
+    }
+
+    if (strcmp(p, "gt") == 0)
+    {
+        return a <= b;
+    }
+
+    if (strcmp(p, "ge") == 0)
+    {
+        return a < b;
+    }
+
+    return TEST_HANDLER_ERROR;
+}
+
+// Expressions are parsed by recursive descent with the usual precedence:
+// parentheses, then !, then -a, then -o. A binary primary is tried before a
+// unary one, so `test -n = -n` compares two strings as POSIX requires.
+
+static bool test_handler_or(TestExpression instance);
+
+static bool test_handler_is(TestExpression instance, String value)
+{
+    return instance->index < instance->count &&
+        strcmp(instance->arguments[instance->index], value) == 0;
+}
+
+static bool test_handler_result(TestExpression instance, int value)
+{
+    if (value == TEST_HANDLER_ERROR)
+    {
+        instance->faulted = true;
+    }
+
+    return !value;
+}
+
+static bool test_handler_primary(TestExpression instance)
+{
+    size_t remaining = instance->count - instance->index;
+    String* arguments = instance->arguments + instance->index;
+
+    if (!remaining)
+    {
+        instance->faulted = true;
+
+        return false;
+    }
+
+    if (remaining >= 3 && test_handler_is_binary(arguments[1]))
+    {
+        instance->index += 3;
+
+        return test_handler_result(
+            instance,
+            test_handler_binary(arguments[0], arguments[1], arguments[2]));
+    }
+
+    if (strcmp(arguments[0], "(") == 0 && remaining >= 2)
+    {
+        instance->index++;
+
+        bool result = test_handler_or(instance);
+
+        if (!test_handler_is(instance, ")"))
+        {
+            instance->faulted = true;
+        }
+
+        instance->index++;
+
+        return result;
+    }
+
+    if (remaining >= 2 && test_handler_is_unary(arguments[0]))
+    {
+        instance->index += 2;
+
+        return test_handler_result(
+            instance,
+            test_handler_unary(arguments[0], arguments[1]));
+    }
+
+    instance->index++;
+
+    return *arguments[0];
+}
+
+static bool test_handler_not(TestExpression instance)
+{
+    if (instance->count - instance->index > 1 && test_handler_is(instance, "!"))
+    {
+        instance->index++;
+
+        return !test_handler_not(instance);
+    }
+
+    return test_handler_primary(instance);
+}
+
+static bool test_handler_and(TestExpression instance)
+{
+    bool result = test_handler_not(instance);
+
+    while (!instance->faulted && test_handler_is(instance, "-a"))
+    {
+        instance->index++;
+
+        bool right = test_handler_not(instance);
+
+        result = result && right;
+    }
+
+    return result;
+}
+
+static bool test_handler_or(TestExpression instance)
+{
+    bool result = test_handler_and(instance);
+
+    while (!instance->faulted && test_handler_is(instance, "-o"))
+    {
+        instance->index++;
+
+        bool right = test_handler_and(instance);
+
+        result = result || right;
+    }
+
+    return result;
+}
+
+static int test_handler_evaluate(String arguments[], size_t count)
+{
+    struct TestExpression expression =
+    {
+        .arguments = arguments,
+        .count = count
+    };
+
+    if (!count)
+    {
+        return 1;
+    }
+
+    bool result = test_handler_or(&expression);
+
+    if (expression.faulted || expression.index != count)
+    {
+        return TEST_HANDLER_ERROR;
+    }
+
+    return !result;
+}
+
+int test_handler(
+    EULER_UNUSED Parser state,
+    Instruction instruction,
+    EULER_UNUSED int input,
+    EULER_UNUSED int output)
+{
+    String* arguments = instruction->arguments;
+    size_t count = instruction->length - 1;
+
+    if (strcmp(arguments[0], "[") == 0)
+    {
+        if (!count || strcmp(arguments[count], "]") != 0)
+        {
+            fprintf(stderr, "Error: invalid command\n");
+
+            return TEST_HANDLER_ERROR;
+        }
+
+        count--;
+    }
+
+    int result = test_handler_evaluate(arguments + 1, count);
+
+    if (result == TEST_HANDLER_ERROR)
+    {
+        fprintf(stderr, "Error: invalid command\n");
+    }
+
+    return result;
+}
@@ -0,0 +1,69 @@
+// time_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man2/getrusage.2.html
+//  - https://www.man7.org/linux/man-pages/man3/clock_gettime.3.html
+//  - https://www.gnu.org/software/bash/manual/html_node/Pipelines.html
+
+#include <sys/resource.h>
+#include <time.h>
+#include "handler.h"
+
+static long time_handler_elapsed(struct timeval start, struct timeval end)
+{
+    return (end.tv_sec - start.tv_sec) * 1000000L +
+        end.tv_usec - start.tv_usec;
+}
+
+static void time_handler_print(String name, long microseconds)
+{
+    long milliseconds = (microseconds + 500) / 1000;
+
+    fprintf(
+        stderr,
+        "%s\t%ldm%ld.%03lds\n",
+        name,
+        milliseconds / 60000,
+        milliseconds / 1000 % 60,
+        milliseconds % 1000);
+}
+
+bool time_handler(Parser state, Instruction instruction)
+{
+    struct timespec start;
+    struct timespec end;
+    struct rusage self[2];
+    struct rusage children[2];
+
+    euler_assert(clock_gettime(CLOCK_MONOTONIC, &start) != -1);
+    euler_assert(getrusage(RUSAGE_SELF, self) != -1);
+    euler_assert(getrusage(RUSAGE_CHILDREN, children) != -1);
+
+    bool result = parser_execute(state, instruction->left);
+
+    euler_assert(clock_gettime(CLOCK_MONOTONIC, &end) != -1);
+    euler_assert(getrusage(RUSAGE_SELF, self + 1) != -1);
+    euler_assert(getrusage(RUSAGE_CHILDREN, children + 1) != -1);
+
+    if (!result)
+    {
+        return false;
+    }
+
+    long real = (end.tv_sec - start.tv_sec) * 1000000L +
+        (end.tv_nsec - start.tv_nsec) / 1000;
+    long user = time_handler_elapsed(self[0].ru_utime, self[1].ru_utime) +
+        time_handler_elapsed(children[0].ru_utime, children[1].ru_utime);
+    long system = time_handler_elapsed(self[0].ru_stime, self[1].ru_stime) +
+        time_handler_elapsed(children[0].ru_stime, children[1].ru_stime);
+
+    fflush(stdout);
+    fprintf(stderr, "\n");
+    time_handler_print("real", real);
+    time_handler_print("user", user);
+    time_handler_print("sys", system);
+
+    return true;
+}
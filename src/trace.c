@@ -0,0 +1,278 @@
+// trace.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man3/clock_gettime.3.html
+//  - https://www.man7.org/linux/man-pages/man3/atexit.3.html
+//  - https://www.man7.org/linux/man-pages/man2/fcntl.2.html
+//  - https://jsonlines.org/
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "trace.h"
+#define TRACE_CAPACITY 1024
+#define TRACE_BUFFER 65536
+#define TRACE_DESCRIPTOR 10
+
+struct Trace
+{
+    int descriptor;
+    pid_t pid;
+    bool output;
+    size_t count;
+    struct TraceEvent events[TRACE_CAPACITY];
+};
+
+static struct Trace trace = { .descriptor = -1 };
+
+static const String TRACE_NAMES[] =
+{
+    "read",
+    "tokenize",
+    "parse",
+    "lookup",
+    "spawn",
+    "exec",
+    "fork",
+    "first_byte",
+    "wait"
+};
+
+bool trace_open(String path)
+{
+    int descriptor = open(
+        path,
+        O_APPEND | O_CLOEXEC | O_CREAT | O_WRONLY,
+        S_IRUSR | S_IWUSR);
+
+    if (descriptor == -1)
+    {
+        return false;
+    }
+
+    trace.descriptor = fcntl(descriptor, F_DUPFD_CLOEXEC, TRACE_DESCRIPTOR);
+
+    close(descriptor);
+
+    if (trace.descriptor == -1)
+    {
+        return false;
+    }
+
+    trace.pid = getpid();
+    trace.output = true;
+    trace.count = 0;
+
+    atexit(trace_close);
+
+    return true;
+}
+
+uint64_t trace_now(void)
+{
+    if (trace.descriptor == -1)
+    {
+        return 0;
+    }
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+void trace_event(
+    TraceType type,
+    uint64_t start,
+    long value,
+    int status,
+    String text)
+{
+    if (trace.descriptor == -1)
+    {
+        return;
+    }
+
+    if (trace.count == TRACE_CAPACITY)
+    {
+        trace_flush();
+    }
+
+    TraceEvent event = trace.events + trace.count;
+
+    event->time = trace_now();
+    event->duration = 0;
+    event->value = value;
+    event->status = status;
+    event->pid = trace.pid;
+    event->type = type;
+    event->text[0] = '\0';
+
+    if (start)
+    {
+        event->duration = event->time - start;
+    }
+
+    if (text)
+    {
+        size_t length = strlen(text);
+
+        if (length >= TRACE_TEXT_CAPACITY)
+        {
+            length = TRACE_TEXT_CAPACITY - 1;
+        }
+
+        memcpy(event->text, text, length);
+
+        event->text[length] = '\0';
+    }
+
+    trace.count++;
+}
+
+void trace_output(void)
+{
+    if (trace.descriptor == -1 || trace.output)
+    {
+        return;
+    }
+
+    trace.output = true;
+
+    trace_event(TRACE_FIRST_BYTE, 0, 0, 0, NULL);
+}
+
+void trace_fork(void)
+{
+    trace.pid = getpid();
+    trace.output = false;
+    trace.count = 0;
+}
+
+static void trace_write(const char* buffer, size_t length)
+{
+    while (length)
+    {
+        ssize_t written = write(trace.descriptor, buffer, length);
+
+        if (written == -1 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (written <= 0)
+        {
+            return;
+        }
+
+        buffer += written;
+        length -= written;
+    }
+}
+
+static void trace_format_text(char* result, size_t capacity, String text)
+{
+    size_t length = 0;
+
+    for (String p = text; *p && length + 7 < capacity; p++)
+    {
+        unsigned char c = *p;
+
+        if (c == '"' || c == '\\')
+        {
+            result[length] = '\\';
+            result[length + 1] = c;
+            length += 2;
+        }
+        else if (c < ' ')
+        {
+            length += snprintf(result + length, 7, "\\u%04x", c);
+        }
+        else
+        {
+            result[length] = c;
+            length++;
+        }
+    }
+
+    result[length] = '\0';
+}
+
+static size_t trace_format(char* result, size_t capacity, TraceEvent event)
+{
+    char text[TRACE_TEXT_CAPACITY * 6 + 1];
+
+    trace_format_text(text, sizeof text, event->text);
+
+    int length = snprintf(
+        result,
+        capacity,
+        "{\"time\":%llu,\"pid\":%ld,\"event\":\"%s\",\"duration\":%llu,"
+        "\"value\":%ld,\"status\":%d,\"text\":\"%s\"}\n",
+        (unsigned long long)event->time,
+        (long)event->pid,
+        TRACE_NAMES[event->type],
+        (unsigned long long)event->duration,
+        event->value,
+        event->status,
+        text);
+
+    if (length < 0 || (size_t)length >= capacity)
+    {
+        return 0;
+    }
+
+    return length;
+}
+
+void trace_flush(void)
+{
+    if (trace.descriptor == -1 || !trace.count)
+    {
+        return;
+    }
+
+    char buffer[TRACE_BUFFER];
+    size_t length = 0;
+
+    for (size_t i = 0; i < trace.count; i++)
+    {
+        size_t written = trace_format(
+            buffer + length,
+            sizeof buffer - length,
+            trace.events + i);
+
+        if (!written)
+        {
+            trace_write(buffer, length);
+
+            length = 0;
+            written = trace_format(buffer, sizeof buffer, trace.events + i);
+        }
+
+        length += written;
+    }
+
+    trace_write(buffer, length);
+
+    trace.count = 0;
+}
+
+void trace_close(void)
+{
+    if (trace.descriptor == -1)
+    {
+        return;
+    }
+
+    trace_flush();
+    close(trace.descriptor);
+
+    trace.descriptor = -1;
+}
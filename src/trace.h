@@ -0,0 +1,59 @@
+// trace.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man3/clock_gettime.3.html
+//  - https://jsonlines.org/
+
+#ifndef TRACE_7c2e9a4b1d3f4e6a8b0c5d2f1e9a3b7c
+#define TRACE_7c2e9a4b1d3f4e6a8b0c5d2f1e9a3b7c
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "euler.h"
+#define TRACE_TEXT_CAPACITY 48
+
+enum TraceType
+{
+    TRACE_READ,
+    TRACE_TOKENIZE,
+    TRACE_PARSE,
+    TRACE_LOOKUP,
+    TRACE_SPAWN,
+    TRACE_EXEC,
+    TRACE_FORK,
+    TRACE_FIRST_BYTE,
+    TRACE_WAIT
+};
+
+struct TraceEvent
+{
+    uint64_t time;
+    uint64_t duration;
+    long value;
+    int status;
+    pid_t pid;
+    enum TraceType type;
+    char text[TRACE_TEXT_CAPACITY];
+};
+
+typedef enum TraceType TraceType;
+typedef struct TraceEvent* TraceEvent;
+
+bool trace_open(String path);
+uint64_t trace_now(void);
+
+void trace_event(
+    TraceType type,
+    uint64_t start,
+    long value,
+    int status,
+    String text);
+
+void trace_output(void);
+void trace_fork(void);
+void trace_flush(void);
+void trace_close(void);
+
+#endif
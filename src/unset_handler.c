@@ -0,0 +1,37 @@
+// unset_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/unset.html
+
+#include <stdio.h>
+#include <string.h>
+#include "handler.h"
+
+int unset_handler(
+    Parser state,
+    Instruction instruction,
+    EULER_UNUSED int input,
+    EULER_UNUSED int output)
+{
+    int result = 0;
+
+    for (size_t i = 1; i < instruction->length; i++)
+    {
+        String name = instruction->arguments[i];
+
+        if (!variable_table_is_name(name, strlen(name)))
+        {
+            fprintf(stderr, "Error: invalid variable\n");
+
+            result = 1;
+
+            continue;
+        }
+
+        variable_table_remove(&state->variables, name);
+    }
+
+    return result;
+}
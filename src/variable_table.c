@@ -0,0 +1,413 @@
+// variable_table.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man7/environ.7.html
+//  - https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/basedefs/V1_chap08.html
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "variable_table.h"
+
+extern char** environ;
+
+Exception variable_table(VariableTable instance, size_t capacity)
+{
+    if (capacity < 64)
+    {
+        capacity = 64;
+    }
+
+    instance->buckets = calloc(capacity, sizeof * instance->buckets);
+
+    if (!instance->buckets)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->exportCapacity = 16;
+    instance->environment = malloc(
+        (instance->exportCapacity + 1) * sizeof * instance->environment);
+    instance->exports = malloc(
+        instance->exportCapacity * sizeof * instance->exports);
+
+    if (!instance->environment || !instance->exports)
+    {
+        free(instance->buckets);
+        free(instance->environment);
+        free(instance->exports);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    instance->environment[0] = NULL;
+    instance->count = 0;
+    instance->capacity = capacity;
+    instance->exportCount = 0;
+    instance->original = environ;
+
+    return 0;
+}
+
+static size_t variable_table_hash(String value, size_t length)
+{
+    size_t result = 14695981039346656037ull;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        result ^= (unsigned char)value[i];
+        result *= 1099511628211ull;
+    }
+
+    return result;
+}
+
+bool variable_table_is_name(String value, size_t length)
+{
+    if (!length || isdigit((unsigned char)value[0]))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (!isalnum((unsigned char)value[i]) && value[i] != '_')
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static Exception variable_table_ensure_capacity(
+    VariableTable instance,
+    size_t capacity)
+{
+    if (instance->capacity >= capacity)
+    {
+        return 0;
+    }
+
+    size_t newCapacity = instance->capacity * 2;
+
+    if (capacity > newCapacity)
+    {
+        newCapacity = capacity;
+    }
+
+    Variable* newBuckets = calloc(newCapacity, sizeof * newBuckets);
+
+    if (!newBuckets)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < instance->capacity; i++)
+    {
+        Variable entry = instance->buckets[i];
+
+        while (entry)
+        {
+            Variable next = entry->next;
+            size_t bucket = entry->hash % newCapacity;
+
+            entry->next = newBuckets[bucket];
+            newBuckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(instance->buckets);
+
+    instance->capacity = newCapacity;
+    instance->buckets = newBuckets;
+
+    return 0;
+}
+
+static Exception variable_table_publish(VariableTable instance, Variable item)
+{
+    if (instance->exportCount == instance->exportCapacity)
+    {
+        size_t newCapacity = instance->exportCapacity * 2;
+        String* newEnvironment = realloc(
+            instance->environment,
+            (newCapacity + 1) * sizeof * newEnvironment);
+
+        if (!newEnvironment)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->environment = newEnvironment;
+
+        if (environ != instance->original)
+        {
+            environ = newEnvironment;
+        }
+
+        Variable* newExports = realloc(
+            instance->exports,
+            newCapacity * sizeof * newExports);
+
+        if (!newExports)
+        {
+            return EXCEPTION_OUT_OF_MEMORY;
+        }
+
+        instance->exportCapacity = newCapacity;
+        instance->exports = newExports;
+    }
+
+    item->exported = true;
+    item->slot = instance->exportCount;
+    instance->environment[item->slot] = item->text;
+    instance->exports[item->slot] = item;
+    instance->exportCount++;
+    instance->environment[instance->exportCount] = NULL;
+
+    return 0;
+}
+
+static void variable_table_unpublish(VariableTable instance, Variable item)
+{
+    instance->exportCount--;
+
+    Variable last = instance->exports[instance->exportCount];
+
+    last->slot = item->slot;
+    instance->exports[item->slot] = last;
+    instance->environment[item->slot] = last->text;
+    instance->environment[instance->exportCount] = NULL;
+}
+
+Variable variable_table_find(
+    VariableTable instance,
+    String name,
+    size_t length)
+{
+    size_t hash = variable_table_hash(name, length);
+
+    for (Variable entry = instance->buckets[hash % instance->capacity];
+        entry;
+        entry = entry->next)
+    {
+        if (entry->hash == hash &&
+            entry->nameLength == length &&
+            memcmp(entry->text, name, length) == 0)
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+String variable_table_get(VariableTable instance, String name)
+{
+    Variable entry = variable_table_find(instance, name, strlen(name));
+
+    if (!entry)
+    {
+        return NULL;
+    }
+
+    return entry->text + entry->nameLength + 1;
+}
+
+Exception variable_table_set(
+    VariableTable instance,
+    String name,
+    size_t length,
+    String value)
+{
+    size_t valueLength = strlen(value);
+    String text = malloc(length + valueLength + 2);
+
+    if (!text)
+    {
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    memcpy(text, name, length);
+    memcpy(text + length + 1, value, valueLength + 1);
+
+    text[length] = '=';
+
+    Variable entry = variable_table_find(instance, name, length);
+
+    if (entry)
+    {
+        free(entry->text);
+
+        entry->text = text;
+
+        if (entry->exported)
+        {
+            instance->environment[entry->slot] = text;
+        }
+
+        return 0;
+    }
+
+    Exception ex = variable_table_ensure_capacity(
+        instance,
+        instance->count + 1);
+
+    if (ex)
+    {
+        free(text);
+
+        return ex;
+    }
+
+    entry = malloc(sizeof * entry);
+
+    if (!entry)
+    {
+        free(text);
+
+        return EXCEPTION_OUT_OF_MEMORY;
+    }
+
+    size_t hash = variable_table_hash(name, length);
+    size_t bucket = hash % instance->capacity;
+
+    entry->text = text;
+    entry->nameLength = length;
+    entry->hash = hash;
+    entry->exported = false;
+    entry->slot = 0;
+    entry->next = instance->buckets[bucket];
+    instance->buckets[bucket] = entry;
+    instance->count++;
+
+    return 0;
+}
+
+Exception variable_table_export(
+    VariableTable instance,
+    String name,
+    size_t length)
+{
+    Variable entry = variable_table_find(instance, name, length);
+
+    if (!entry)
+    {
+        Exception ex = variable_table_set(instance, name, length, "");
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        entry = variable_table_find(instance, name, length);
+    }
+
+    if (entry->exported)
+    {
+        return 0;
+    }
+
+    return variable_table_publish(instance, entry);
+}
+
+Exception variable_table_import(VariableTable instance, char* environment[])
+{
+    for (String* p = environment; *p; p++)
+    {
+        String separator = strchr(*p, '=');
+
+        if (!separator)
+        {
+            continue;
+        }
+
+        size_t length = separator - *p;
+        Exception ex = variable_table_set(instance, *p, length, separator + 1);
+
+        if (ex)
+        {
+            return ex;
+        }
+
+        ex = variable_table_export(instance, *p, length);
+
+        if (ex)
+        {
+            return ex;
+        }
+    }
+
+    environ = instance->environment;
+
+    return 0;
+}
+
+void variable_table_remove(VariableTable instance, String name)
+{
+    size_t length = strlen(name);
+    size_t hash = variable_table_hash(name, length);
+    Variable* link = instance->buckets + hash % instance->capacity;
+
+    for (; *link; link = &(*link)->next)
+    {
+        Variable entry = *link;
+
+        if (entry->hash != hash ||
+            entry->nameLength != length ||
+            memcmp(entry->text, name, length) != 0)
+        {
+            continue;
+        }
+
+        if (entry->exported)
+        {
+            variable_table_unpublish(instance, entry);
+        }
+
+        *link = entry->next;
+        instance->count--;
+
+        free(entry->text);
+        free(entry);
+
+        return;
+    }
+}
+
+void finalize_variable_table(VariableTable instance)
+{
+    environ = instance->original;
+
+    for (size_t i = 0; i < instance->capacity; i++)
+    {
+        Variable entry = instance->buckets[i];
+
+        while (entry)
+        {
+            Variable next = entry->next;
+
+            free(entry->text);
+            free(entry);
+
+            entry = next;
+        }
+    }
+
+    free(instance->buckets);
+    free(instance->environment);
+    free(instance->exports);
+
+    instance->count = 0;
+    instance->capacity = 0;
+    instance->buckets = NULL;
+    instance->exportCount = 0;
+    instance->exportCapacity = 0;
+    instance->environment = NULL;
+    instance->exports = NULL;
+}
@@ -0,0 +1,65 @@
+// variable_table.h
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://www.man7.org/linux/man-pages/man7/environ.7.html
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+
+#ifndef VARIABLE_TABLE_7c3e1a9b5d2f4b8e9a6c0d4f1e3b2a5c
+#define VARIABLE_TABLE_7c3e1a9b5d2f4b8e9a6c0d4f1e3b2a5c
+#include <stdbool.h>
+#include <stddef.h>
+#include "euler.h"
+
+struct Variable
+{
+    char* text;
+    size_t nameLength;
+    size_t hash;
+    bool exported;
+    size_t slot;
+    struct Variable* next;
+};
+
+struct VariableTable
+{
+    size_t count;
+    size_t capacity;
+    struct Variable** buckets;
+    size_t exportCount;
+    size_t exportCapacity;
+    char** environment;
+    struct Variable** exports;
+    char** original;
+};
+
+typedef struct Variable* Variable;
+typedef struct VariableTable* VariableTable;
+
+Exception variable_table(VariableTable instance, size_t capacity);
+Exception variable_table_import(VariableTable instance, char* environment[]);
+
+Variable variable_table_find(
+    VariableTable instance,
+    String name,
+    size_t length);
+
+String variable_table_get(VariableTable instance, String name);
+
+Exception variable_table_set(
+    VariableTable instance,
+    String name,
+    size_t length,
+    String value);
+
+Exception variable_table_export(
+    VariableTable instance,
+    String name,
+    size_t length);
+
+void variable_table_remove(VariableTable instance, String name);
+bool variable_table_is_name(String value, size_t length);
+void finalize_variable_table(VariableTable instance);
+
+#endif
@@ -0,0 +1,127 @@
+// while_handler.c
+// Copyright (c) 2024 Ishan Pranav
+// Licensed under the MIT license.
+
+// References:
+//  - https://pubs.opengroup.org/onlinepubs/9699919799/utilities/V3_chap02.html
+//  - https://www.man7.org/linux/man-pages/man2/sigaction.2.html
+
+#include <signal.h>
+#include "handler.h"
+
+static volatile sig_atomic_t whileInterrupted;
+
+static void while_handler_on_interrupt(EULER_UNUSED int signal)
+{
+    whileInterrupted = 1;
+}
+
+// An interactive shell ignores SIGINT, so a loop made only of builtins
+// would never see Ctrl-C. While the outermost loop runs, SIGINT sets a flag
+// instead. A shell that does not ignore SIGINT is left to terminate.
+
+bool while_handler_begin(struct sigaction* previous)
+{
+    struct sigaction action = { 0 };
+
+    euler_assert(sigaction(SIGINT, NULL, previous) != -1);
+
+    if (previous->sa_handler != SIG_IGN)
+    {
+        return false;
+    }
+
+    whileInterrupted = 0;
+    action.sa_handler = while_handler_on_interrupt;
+    action.sa_flags = SA_RESTART;
+
+    sigemptyset(&action.sa_mask);
+    euler_assert(sigaction(SIGINT, &action, NULL) != -1);
+
+    return true;
+}
+
+bool while_handler_interrupted(Parser state)
+{
+    if (!whileInterrupted && state->status != 128 + SIGINT)
+    {
+        return false;
+    }
+
+    state->status = 128 + SIGINT;
+
+    return true;
+}
+
+void while_handler_end(bool installed, const struct sigaction* previous)
+{
+    if (installed)
+    {
+        euler_assert(sigaction(SIGINT, previous, NULL) != -1);
+    }
+}
+
+bool while_handler(Parser state, Instruction instruction)
+{
+    bool expected = instruction->type == INSTRUCTION_WHILE;
+    bool result = true;
+    int status = 0;
+    struct ArenaMark mark = arena_mark(&state->arena);
+    struct sigaction previous;
+    bool installed = while_handler_begin(&previous);
+
+    for (;;)
+    {
+        if (!parser_execute(state, instruction->left))
+        {
+            result = false;
+
+            break;
+        }
+
+        if (while_handler_interrupted(state))
+        {
+            status = state->status;
+
+            break;
+        }
+
+        if (!state->status != expected)
+        {
+            break;
+        }
+
+        if (!parser_execute(state, instruction->right))
+        {
+            result = false;
+
+            break;
+        }
+
+        status = state->status;
+
+        arena_rewind(&state->arena, mark);
+        directory_cache_clear(&state->directories);
+
+        if (job_collection_changed())
+        {
+            job_collection_reap(&state->jobs);
+        }
+
+        if (while_handler_interrupted(state))
+        {
+            status = state->status;
+
+            break;
+        }
+    }
+
+    while_handler_end(installed, &previous);
+
+    if (result)
+    {
+        state->status = status;
+    }
+
+    return result;
+}